@@ -0,0 +1,225 @@
+/**
+ * @file alloc_budget.cpp
+ * @brief count the heap allocations of a warmed-up 'SetupFlags' per phase, and fail if any phase of
+ * the representative schemas exceeds its budget
+ */
+
+#include "flags.hpp"
+#include "reloadable.hpp"
+#include "array"
+#include "iostream"
+#include "sstream"
+#include "iomanip"
+#include "cstdlib"
+#include "new"
+
+namespace {
+    std::size_t allocCount = 0;
+    std::size_t allocBytes = 0;
+}
+
+// the replacements aren't inlined, otherwise gcc mistakes the pairs of them for mismatched ones
+[[gnu::noinline]] void *operator new(std::size_t size) {
+    ++allocCount;
+    allocBytes += size;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+    using namespace ns_flags;
+
+    constexpr std::size_t PHASE_COUNT = static_cast<std::size_t>(ParsePhase::HELP) + 1;
+    // the whole 'SetupFlags', including the work outside of the phases
+    constexpr std::size_t TOTAL = PHASE_COUNT;
+
+    struct Usage {
+        std::size_t count = 0, bytes = 0;
+    };
+
+    using Budget = std::array<std::size_t, PHASE_COUNT + 1>;
+    using Report = std::array<Usage, PHASE_COUNT + 1>;
+
+    struct Schema {
+        std::string name;
+        std::function<void(OptionParser &)> registrar;
+        std::vector<const char *> argv;
+        // the allocation count of a single parse
+        Budget budget;
+        // whether 'SetupFlags' should throw, e.g. the help docs
+        bool throws = false;
+    };
+
+    /**
+     * @brief a typical tool, scalars with assertors, a required option and a default option
+     */
+    void ScalarSchema(OptionParser &parser) {
+        parser.AddOption<Int>("age", 'a', 18, "the age", OptionProp::OPTIONAL,
+                              [](const int &val) -> std::optional<std::string> {
+                                  if (val > 0) { return {}; }
+                                  return "the age should be positive";
+                              });
+        parser.AddOption<Bool>("verbose", 'V', false, "print more", OptionProp::OPTIONAL);
+        parser.AddOption<Double>("rate", 'r', 0.5, "the rate", OptionProp::OPTIONAL);
+        parser.AddOption<Validated<Float, Range<0, 300>>>("height", 174.5f, "the height", OptionProp::OPTIONAL);
+        parser.AddOption<String>("name", "null", "the name", OptionProp::REQUIRED);
+        parser.AddDefaultOption<String>("hello, world!", "a note", OptionProp::OPTIONAL);
+    }
+
+    /**
+     * @brief a data-heavy tool, vectors with validators
+     */
+    void VectorSchema(OptionParser &parser) {
+        parser.AddOption<Validated<IntVec, Each<Odd>>>("odds", 'o', {1, 3}, "the odd numbers", OptionProp::OPTIONAL);
+        parser.AddOption<DoubleVec>("weights", 'w', {}, "the weights", OptionProp::OPTIONAL);
+        parser.AddOption<BoolVec>("masks", {}, "the masks", OptionProp::OPTIONAL);
+        parser.AddOption<StringVec>("files", 'f', {}, "the files", OptionProp::REQUIRED);
+    }
+
+    /**
+     * @brief a service with many options and the constraints between them, lazy default values and
+     * reloadable options
+     */
+    void ConstraintSchema(OptionParser &parser) {
+        for (int i = 0; i != 64; ++i) {
+            parser.AddOption<Int>("opt" + std::to_string(i), i, "a padding option", OptionProp::OPTIONAL);
+        }
+        parser.AddOption<Bool>("json", 'j', false, "print json", OptionProp::OPTIONAL);
+        parser.AddOption<Bool>("xml", 'x', false, "print xml", OptionProp::OPTIONAL);
+        parser.AddOption<String>("user", 'u', "", "the user", OptionProp::OPTIONAL);
+        parser.AddOption<String>("password", 'p', "", "the password", OptionProp::OPTIONAL);
+        parser.AddLazyOption<Int>("threads", 't', [] { return 8; }, "the threads", OptionProp::OPTIONAL);
+        parser.AddLazyOption<String>("home", [] { return std::string("/home/flags"); }, "the home",
+                                     OptionProp::OPTIONAL);
+        parser.AddReloadableOption<Int>("level", 'l', 1, "the log level", OptionProp::OPTIONAL);
+        parser.AddMutuallyExclusive({"json", "xml"});
+        parser.AddExactlyOne({"opt1", "opt63"});
+        parser.AddRequirement("user", {"password"});
+    }
+
+    /**
+     * @brief a tool with subcommands, the top-level options are followed by the selected subcommand
+     */
+    void SubcommandSchema(OptionParser &parser) {
+        parser.AddOption<Bool>("verbose", 'V', false, "print more", OptionProp::OPTIONAL);
+        parser.AddOption<String>("config", 'c', "flags.conf", "the config file", OptionProp::OPTIONAL);
+        parser.AddSubcommand("train", "train the model", [](OptionParser &sub) {
+            sub.AddOption<Int>("epochs", 'e', 10, "the epochs", OptionProp::REQUIRED);
+            sub.AddOption<Double>("rate", 'r', 0.01, "the learning rate", OptionProp::OPTIONAL);
+            sub.AddOption<StringVec>("data", 'd', {}, "the data files", OptionProp::OPTIONAL);
+        });
+        parser.AddSubcommand("eval", "evaluate the model", [](OptionParser &sub) {
+            sub.AddOption<String>("model", 'm', "", "the model file", OptionProp::REQUIRED);
+        });
+    }
+
+    Report Measure(const Schema &schema, std::size_t warmUps, std::size_t rounds) {
+        OptionParser parser;
+        schema.registrar(parser);
+
+        Report report{};
+        std::array<Usage, PHASE_COUNT> begin{};
+        parser.SetPhaseObserver([&report, &begin](ParsePhase phase, bool start) {
+            auto idx = static_cast<std::size_t>(phase);
+            if (start) {
+                begin[idx] = {allocCount, allocBytes};
+            } else {
+                report[idx].count += allocCount - begin[idx].count;
+                report[idx].bytes += allocBytes - begin[idx].bytes;
+            }
+        });
+
+        auto parse = [&parser, &schema]() {
+            bool thrown = false;
+            try {
+                parser.SetupFlags(static_cast<int>(schema.argv.size()), const_cast<const char **>(schema.argv.data()));
+            } catch (const std::runtime_error &e) {
+                // a parse failed in any phase would allocate less than a successful one
+                if (!schema.throws) {
+                    throw;
+                }
+                thrown = true;
+            }
+            if (schema.throws && !thrown) {
+                throw std::runtime_error("'SetupFlags' should throw, but it didn't");
+            }
+        };
+        for (std::size_t i = 0; i != warmUps; ++i) {
+            parse();
+        }
+        report = Report{};
+        Usage total{allocCount, allocBytes};
+        for (std::size_t i = 0; i != rounds; ++i) {
+            parse();
+        }
+        report[TOTAL] = {allocCount - total.count, allocBytes - total.bytes};
+        // the sums of all the rounds, they are compared with the budgets of the rounds, so no
+        // allocation is lost in the averaging
+        return report;
+    }
+}
+
+int main() {
+    const std::size_t warmUps = 3, rounds = 16;
+    // the budgets of Tokenize, Constraint, Convert, Assert, Resolve, Publish, Help and the total, the phases
+    // of the top-level parser and the subcommand are added up
+    const std::vector<Schema> schemas{
+            {"scalar",     ScalarSchema,     {"prog", "note", "--name", "bob", "-a", "22", "-V", "--rate", "0.7",
+                                                     "--height", "180"},
+                    {16, 0, 2, 0, 0, 0, 0, 20}},
+            {"vector",     VectorSchema,     {"prog", "-o", "1", "3", "5", "7", "-w", "0.5", "1.5", "--masks", "on",
+                                                     "off", "-f", "a.txt", "b.txt"},
+                    {20, 0, 2, 0, 0, 0, 0, 24}},
+            {"constraint", ConstraintSchema, {"prog", "--opt1", "2", "-j", "-u", "root", "-p", "secret", "--opt40",
+                                                     "7", "-l", "3"},
+                    {16, 0, 2, 0, 0, 0, 0, 20}},
+            {"subcommand", SubcommandSchema, {"prog", "-V", "on", "--config", "my.conf", "train", "-e", "20",
+                                                     "--rate", "0.1", "-d", "a.bin", "b.bin"},
+                    {20, 0, 2, 0, 0, 0, 0, 24}},
+            {"help",       ScalarSchema,     {"prog", "--help"},
+                    {6, 0, 0, 0, 0, 0, 12, 24}, true},
+    };
+
+    bool exceeded = false;
+    std::cout << std::left << std::setw(12) << "schema" << std::setw(12) << "phase"
+              << std::setw(14) << "allocations" << std::setw(10) << "bytes" << "budget\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto &schema: schemas) {
+        Report report;
+        try {
+            report = Measure(schema, warmUps, rounds);
+        } catch (const std::exception &e) {
+            std::cerr << "the schema '" << schema.name << "' failed: " << e.what() << '\n';
+            return EXIT_FAILURE;
+        }
+        for (std::size_t idx = 0; idx != report.size(); ++idx) {
+            std::stringstream phase;
+            if (idx == TOTAL) {
+                phase << "Total";
+            } else {
+                phase << static_cast<ParsePhase>(idx);
+            }
+            bool over = report[idx].count > schema.budget[idx] * rounds;
+            exceeded = exceeded || over;
+            std::cout << std::setw(12) << schema.name << std::setw(12) << phase.str()
+                      << std::setw(14) << static_cast<double>(report[idx].count) / rounds
+                      << std::setw(10) << static_cast<double>(report[idx].bytes) / rounds
+                      << schema.budget[idx] << (over ? "  <- exceeded" : "") << '\n';
+        }
+    }
+    if (exceeded) {
+        std::cerr << "the allocation budget is exceeded\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,13 @@
+/**
+ * @file flags.cpp
+ * @brief the compiled 'flags' library, which holds the parser, the non-template members of 'OptionParser'
+ * and the instantiations of 'AddOption' for the built-in argument types
+ */
+
+#define FLAGS_COMPILED_LIB_BUILD
+
+#include "flags.hpp"
+
+namespace ns_flags {
+    FLAGS_ADD_OPTION_INSTANTIATIONS(template)
+}
@@ -10,11 +10,26 @@
 #include "vector"
 #include "string"
 #include "algorithm"
-#include "sstream"
-#include "iostream"
-#include "fstream"
+#include "iosfwd"
+#include "unordered_map"
+#include "cstring"
+#include "type_traits"
 
 namespace ns_flags {
+    template<class CharT, class Traits, class ElemType>
+    static std::basic_ostream<CharT, Traits> &
+    operator<<(std::basic_ostream<CharT, Traits> &os, const std::vector<ElemType> &vec) {
+        os << '[';
+        if (vec.empty()) {
+            os << ']';
+        } else {
+            for (int i = 0; i != vec.size() - 1; ++i) { os << vec.at(i) << ", "; }
+            os << vec.back();
+            os << ']';
+        }
+        return os;
+    }
+
     struct Utils {
     public:
         /**
@@ -55,32 +70,120 @@ namespace ns_flags {
 
         /**
          * @brief a function to read all chars in the file and return a string
-         * @param file the opened output file stream reference
+         * @param file the opened input file stream reference
          * @return the char string in the file
          */
-        static std::string ReadStringFromFile(std::ifstream &file) {
-            file.seekg(0, std::ios::end);
-            auto size = file.tellg();
-            file.seekg(0, std::ios::beg);
-            std::string str(size, ' ');
-            file.read(const_cast<char *>(str.c_str()), size);
-            return str;
+        static std::string ReadStringFromFile(std::istream &file);
+
+        /**
+         * @brief the value strings of the data types of the built-in argument types, they are defined
+         * out of line, so the string streams aren't needed here
+         */
+        static std::string ToString(bool data);
+
+        static std::string ToString(int data);
+
+        static std::string ToString(float data);
+
+        static std::string ToString(double data);
+
+        static std::string ToString(const std::string &data);
+
+        static std::string ToString(const std::vector<bool> &data);
+
+        static std::string ToString(const std::vector<int> &data);
+
+        static std::string ToString(const std::vector<float> &data);
+
+        static std::string ToString(const std::vector<double> &data);
+
+        static std::string ToString(const std::vector<std::string> &data);
+
+        /**
+         * @brief the value string of the other data types, '<sstream>' should be included to use it
+         */
+        template<class DataType, class StringStream = std::ostringstream>
+        static std::string ToString(const DataType &data) {
+            StringStream stream;
+            stream.setf(StringStream::boolalpha);
+            stream << data;
+            return stream.str();
         }
-    };
 
-    template<typename ElemType>
-    static std::ostream &operator<<(std::ostream &os, const std::vector<ElemType> &vec) {
-        os << '[';
-        if (vec.empty()) {
-            os << ']';
-        } else {
-            for (int i = 0; i != vec.size() - 1; ++i) { os << vec.at(i) << ", "; }
-            os << vec.back();
-            os << ']';
+        /**
+         * @brief print an argument like 'Int{data: 18}'
+         */
+        static std::ostream &PrintArgument(std::ostream &os, const std::string &typeName, const std::string &value);
+
+        /**
+         * @brief convert a single argv to the element type of the built-in argument types
+         */
+        template<class ElemType>
+        static ElemType FromString(const std::string &str) {
+            if constexpr (std::is_same_v<ElemType, bool>) {
+                return StrToBool(str);
+            } else if constexpr (std::is_same_v<ElemType, int>) {
+                return std::stoi(str);
+            } else if constexpr (std::is_same_v<ElemType, float>) {
+                return std::stof(str);
+            } else if constexpr (std::is_same_v<ElemType, double>) {
+                return std::stod(str);
+            } else {
+                static_assert(std::is_same_v<ElemType, std::string>, "unsupported element type");
+                return str;
+            }
         }
-        return os;
-    }
 
+        template<class Type>
+        struct IsContiguousOfTrivial : std::false_type {
+        };
+
+        template<class ElemType>
+        struct IsContiguousOfTrivial<std::vector<ElemType>> : std::is_trivially_copyable<ElemType> {
+        };
+
+        /**
+         * @brief the size of the raw bytes of the data, which can be viewed without parsing, supported
+         * types are trivially copyable types, vectors and spans of them, and 'std::string'
+         *
+         * @return empty if the data can't be represented by raw bytes
+         */
+        template<class DataType>
+        static std::optional<std::size_t> RawBytesSize(const DataType &data) {
+            if constexpr (std::is_trivially_copyable_v<DataType>) {
+                return sizeof(DataType);
+            } else if constexpr (std::is_same_v<DataType, std::string>) {
+                return data.size();
+            } else if constexpr (std::is_same_v<DataType, std::vector<bool>>) {
+                // 'std::vector<bool>' is packed, so store one 'bool' per element
+                return data.size() * sizeof(bool);
+            } else if constexpr (IsContiguousOfTrivial<DataType>::value) {
+                return data.size() * sizeof(*data.data());
+            } else {
+                return {};
+            }
+        }
+
+        /**
+         * @brief write the raw bytes of the data to 'dest', which has 'RawBytesSize(data)' bytes at least
+         */
+        template<class DataType>
+        static void DataToRawBytes(const DataType &data, char *dest) {
+            if constexpr (std::is_trivially_copyable_v<DataType>) {
+                std::memcpy(dest, &data, sizeof(DataType));
+            } else if constexpr (std::is_same_v<DataType, std::string>) {
+                std::memcpy(dest, data.data(), data.size());
+            } else if constexpr (std::is_same_v<DataType, std::vector<bool>>) {
+                for (bool elem: data) {
+                    std::memcpy(dest, &elem, sizeof(bool));
+                    dest += sizeof(bool);
+                }
+            } else if constexpr (IsContiguousOfTrivial<DataType>::value) {
+                std::memcpy(dest, data.data(), data.size() * sizeof(*data.data()));
+            }
+        }
+
+    };
 
     struct Argument {
     public:
@@ -96,6 +199,23 @@ namespace ns_flags {
         BoostType *Boost() { return dynamic_cast<BoostType *>(this); }
 
         virtual std::optional<std::string> DataFromStringVector(const std::vector<std::string> &strVec) = 0;
+
+        /**
+         * @brief whether converting no argv keeps the previous data, e.g. '--threads' without any value
+         */
+        [[nodiscard]] virtual bool KeepsDataOnEmptyInput() const { return true; }
+
+        /**
+         * @brief the size of the raw bytes of the data, used to share the data between processes
+         *
+         * @return empty if the data can't be represented by raw bytes
+         */
+        [[nodiscard]] virtual std::optional<std::size_t> RawBytesSize() const { return {}; }
+
+        /**
+         * @brief write the raw bytes of the data to 'dest', which has 'RawBytesSize()' bytes at least
+         */
+        virtual void DataToRawBytes(char *) const {}
     };
 
 #define FLAGS_ARGUMENT_TEMPLATE_GENERATOR_BEGIN(ArgType, DataType)                    \
@@ -111,23 +231,37 @@ namespace ns_flags {
                                                                                       \
     ~ArgType() override = default;                                                    \
                                                                                       \
-    [[nodiscard]] std::string TypeNameString() const override {                       \
+    static const char *TypeName() {                                                   \
       return #ArgType;                                                                \
     }                                                                                 \
                                                                                       \
+    [[nodiscard]] std::string TypeNameString() const override {                       \
+      return TypeName();                                                              \
+    }                                                                                 \
+                                                                                      \
     [[nodiscard]] std::string ValueString() const override {                          \
-      std::stringstream stream;                                                       \
-      stream << std::boolalpha << data;                                               \
-      return stream.str();                                                            \
+      return ns_flags::Utils::ToString(data);                                         \
     }                                                                                 \
                                                                                       \
-    [[nodiscard]] const DataType &GetData() const {                                   \
+    [[nodiscard]] virtual const DataType &GetData() const {                           \
       return data;                                                                    \
     }                                                                                 \
                                                                                       \
+    virtual void SetData(const DataType &newData) {                                   \
+      data = newData;                                                                 \
+    }                                                                                 \
+                                                                                      \
+    [[nodiscard]] std::optional<std::size_t> RawBytesSize() const override {          \
+      return ns_flags::Utils::RawBytesSize(data);                                     \
+    }                                                                                 \
+                                                                                      \
+    void DataToRawBytes(char *dest) const override {                                  \
+      ns_flags::Utils::DataToRawBytes(data, dest);                                    \
+    }                                                                                 \
+                                                                                      \
     friend std::ostream &operator<<(std::ostream &os, const ArgType &obj) {           \
-      os << obj.TypeNameString() << "{data: " << obj.data << '}';                     \
-      return os;                                                                      \
+      return ns_flags::Utils::PrintArgument(os, obj.TypeNameString(),                 \
+                                            obj.ValueString());                       \
     }
 #define FLAGS_ARGUMENT_TEMPLATE_GENERATOR_END };
 
@@ -156,6 +290,10 @@ namespace ns_flags {
             });
             return {};
         }
+
+        [[nodiscard]] bool KeepsDataOnEmptyInput() const override {
+            return false;
+        }
     FLAGS_ARGUMENT_TEMPLATE_GENERATOR_END
 
     /**
@@ -171,6 +309,10 @@ namespace ns_flags {
             }
             return {};
         }
+
+        [[nodiscard]] bool KeepsDataOnEmptyInput() const override {
+            return false;
+        }
     FLAGS_ARGUMENT_TEMPLATE_GENERATOR_END
 
     /**
@@ -185,6 +327,10 @@ namespace ns_flags {
             });
             return {};
         }
+
+        [[nodiscard]] bool KeepsDataOnEmptyInput() const override {
+            return false;
+        }
     FLAGS_ARGUMENT_TEMPLATE_GENERATOR_END
 
     /**
@@ -212,6 +358,10 @@ namespace ns_flags {
             });
             return {};
         }
+
+        [[nodiscard]] bool KeepsDataOnEmptyInput() const override {
+            return false;
+        }
     FLAGS_ARGUMENT_TEMPLATE_GENERATOR_END
 
     /**
@@ -239,6 +389,10 @@ namespace ns_flags {
             });
             return {};
         }
+
+        [[nodiscard]] bool KeepsDataOnEmptyInput() const override {
+            return false;
+        }
     FLAGS_ARGUMENT_TEMPLATE_GENERATOR_END
 
     /**
@@ -263,6 +417,10 @@ namespace ns_flags {
             data = strVec;
             return {};
         }
+
+        [[nodiscard]] bool KeepsDataOnEmptyInput() const override {
+            return false;
+        }
     FLAGS_ARGUMENT_TEMPLATE_GENERATOR_END
 
     /**
@@ -291,6 +449,92 @@ namespace ns_flags {
         }
     FLAGS_ARGUMENT_TEMPLATE_GENERATOR_END
 
+
+    /**
+     * @brief an argument which converts the argv(s) straight into an object of the user, like a member
+     * of a config struct, the object should outlive the argument
+     *
+     * @attention the data of the base type is only the scratch of the conversion, 'GetData' and 'SetData'
+     * access the object, also through 'Boost<ArgumentType>()'
+     */
+    template<class ArgumentType>
+    struct Bound : ArgumentType {
+    public:
+        using data_type = typename ArgumentType::data_type;
+
+    protected:
+        data_type *target;
+
+    public:
+        explicit Bound(data_type &target) : ArgumentType(), target(&target) {}
+
+        ~Bound() override = default;
+
+        [[nodiscard]] std::string ValueString() const override {
+            return Utils::ToString(*target);
+        }
+
+        [[nodiscard]] const data_type &GetData() const override {
+            return *target;
+        }
+
+        void SetData(const data_type &newData) override {
+            *target = newData;
+        }
+
+        std::optional<std::string> DataFromStringVector(const std::vector<std::string> &strVec) override {
+            // the target is written only if the conversion succeeds, so a failed one leaves it untouched
+            if (this->KeepsDataOnEmptyInput()) {
+                // the conversion may keep the current value
+                this->data = *target;
+            }
+            auto msg = ArgumentType::DataFromStringVector(strVec);
+            if (!msg) {
+                *target = std::move(this->data);
+            }
+            // don't keep a second copy of the object
+            this->data = data_type();
+            return msg;
+        }
+
+        [[nodiscard]] std::optional<std::size_t> RawBytesSize() const override {
+            return Utils::RawBytesSize(*target);
+        }
+
+        void DataToRawBytes(char *dest) const override {
+            Utils::DataToRawBytes(*target, dest);
+        }
+    };
+
+    /**
+     * @brief the default value of a bound option, only its value string at the binding is kept for display
+     */
+    struct BoundDefault : Argument {
+    protected:
+        std::string typeName;
+        std::string valueString;
+
+    public:
+        BoundDefault(std::string typeName, std::string valueString)
+                : Argument(), typeName(std::move(typeName)), valueString(std::move(valueString)) {}
+
+        ~BoundDefault() override = default;
+
+        [[nodiscard]] std::string ValueString() const override {
+            return valueString;
+        }
+
+        [[nodiscard]] std::string TypeNameString() const override {
+            return typeName;
+        }
+
+        std::optional<std::string> DataFromStringVector(const std::vector<std::string> &strVec) override {
+            if (!strVec.empty()) {
+                valueString = strVec.front();
+            }
+            return {};
+        }
+    };
 }
 
 #endif
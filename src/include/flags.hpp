@@ -13,9 +13,19 @@
 
 #include "utility"
 #include "arg_type.hpp"
+#include "validator.hpp"
 #include "exception"
-#include "map"
-#include "iomanip"
+#include "stdexcept"
+#include "functional"
+#include "iosfwd"
+
+// the non-template members of 'OptionParser' are defined in 'flags_impl.hpp', which is compiled into
+// the 'flags' library if 'FLAGS_COMPILED_LIB' is defined, and included in this header otherwise
+#ifdef FLAGS_COMPILED_LIB
+#define FLAGS_INLINE
+#else
+#define FLAGS_INLINE inline
+#endif
 
 namespace ns_flags {
 
@@ -27,6 +37,10 @@ namespace ns_flags {
   throw std::runtime_error(std::string("[ error from 'lib-flags':'") + #where + "' ] " + \
                            msg + ". (this message is send to the developer only)")
 
+    // defined in 'reloadable.hpp', which should be included to add the reloadable options
+    template<class DataType, std::size_t SlotCount = 4>
+    class Reloadable;
+
     enum class OptionProp {
         // the option is optional
         OPTIONAL,
@@ -34,40 +48,128 @@ namespace ns_flags {
         REQUIRED
     };
 
-    static std::ostream &operator<<(std::ostream &os, const OptionProp &obj) {
-        switch (obj) {
-            case OptionProp::OPTIONAL:
-                os << "Optional";
-                break;
-            case OptionProp::REQUIRED:
-                os << "Required";
-                break;
-        }
-        return os;
-    }
+    FLAGS_INLINE std::ostream &operator<<(std::ostream &os, const OptionProp &obj);
+
+    enum class ParsePhase {
+        // split the argv(s) to the options
+        TOKENIZE,
+        // check the required options and the constraints
+        CONSTRAINT,
+        // convert the argv(s) to the values of the options
+        CONVERT,
+        // run the assertors of the options
+        ASSERT,
+        // evaluate the lazy default values of the options which are not passed in
+        RESOLVE,
+        // publish the values of the reloadable options
+        PUBLISH,
+        // generate the help docs
+        HELP
+    };
+
+    FLAGS_INLINE std::ostream &operator<<(std::ostream &os, const ParsePhase &obj);
 
     struct Variable {
+    public:
+        struct LazyDefaultState {
+            // assigns the result of the thunk to the default value
+            std::function<void()> evaluate;
+            // assigns the default value to the value
+            std::function<void()> assignValue;
+            bool evaluated = false;
+        };
+
     public:
         std::shared_ptr<Argument> defaultValue, value;
+        // it's nullptr if the default value is given eagerly
+        std::shared_ptr<LazyDefaultState> lazyDefault;
 
         template<class ArgumentType>
         static auto Create(const typename ArgumentType::data_type &defaultValue) {
             return Variable(std::make_shared<ArgumentType>(defaultValue), std::make_shared<ArgumentType>(defaultValue));
         }
 
+        /**
+         * @brief the value is converted straight into the target, and only the value string of its
+         * initial value is kept as the default value for display
+         */
+        template<class ArgumentType>
+        static auto CreateBound(typename ArgumentType::data_type &target) {
+            auto value = std::make_shared<Bound<ArgumentType>>(target);
+            return Variable(std::make_shared<BoundDefault>(value->TypeNameString(), value->ValueString()), value);
+        }
+
+        /**
+         * @brief the default value is computed by the thunk at most once, and only when it's needed
+         */
+        template<class ArgumentType>
+        static auto CreateLazy(std::function<typename ArgumentType::data_type()> thunk) {
+            auto variable = Variable(std::make_shared<ArgumentType>(), std::make_shared<ArgumentType>());
+            variable.lazyDefault = std::make_shared<LazyDefaultState>();
+            variable.lazyDefault->evaluate = [thunk = std::move(thunk), def = variable.defaultValue]() {
+                def->template Boost<ArgumentType>()->SetData(thunk());
+            };
+            variable.lazyDefault->assignValue = [def = variable.defaultValue, val = variable.value]() {
+                val->template Boost<ArgumentType>()->SetData(def->template Boost<ArgumentType>()->GetData());
+            };
+            return variable;
+        }
+
+        /**
+         * @brief evaluate the lazy default value if it hasn't been evaluated
+         */
+        void ResolveDefault() const {
+            if (lazyDefault != nullptr && !lazyDefault->evaluated) {
+                lazyDefault->evaluate();
+                lazyDefault->evaluated = true;
+            }
+        }
+
+        /**
+         * @brief assign the lazy default value to the value, for the options which are not passed in
+         */
+        void ResolveValue() const {
+            if (lazyDefault != nullptr) {
+                ResolveDefault();
+                lazyDefault->assignValue();
+            }
+        }
+
     protected:
         Variable(const std::shared_ptr<Argument> &defaultValue, const std::shared_ptr<Argument> &value)
-                : defaultValue(defaultValue), value(value) {}
+                : defaultValue(defaultValue), value(value), lazyDefault(nullptr) {}
 
 
-        friend std::ostream &operator<<(std::ostream &os, const Variable &variable) {
-            os << "'defaultValue': " << variable.defaultValue->ValueString()
-               << ", 'value': " << variable.value->ValueString();
-            return os;
-        }
+        friend FLAGS_INLINE std::ostream &operator<<(std::ostream &os, const Variable &variable);
     };
 
     namespace ns_priv {
+        /**
+         * @brief notify the observer when a phase of 'SetupFlags' begins and ends
+         */
+        struct PhaseScope {
+        public:
+            using observer_type = std::function<void(ParsePhase, bool)>;
+
+        private:
+            const observer_type &observer;
+            const ParsePhase phase;
+            bool finished;
+
+        public:
+            PhaseScope(const observer_type &observer, ParsePhase phase)
+                    : observer(observer), phase(phase), finished(false) {
+                if (observer) { observer(phase, true); }
+            }
+
+            void Finish() {
+                if (!finished && observer) { observer(phase, false); }
+                finished = true;
+            }
+
+            ~PhaseScope() { Finish(); }
+        };
+
         enum class OptionNameType {
             OPT_SHORT_NAME, OPT_LONG_NAME, NONE
         };
@@ -79,7 +181,7 @@ namespace ns_flags {
          * @return true
          * @return false
          */
-        static OptionNameType IsAnOption(const std::string &str) {
+        inline OptionNameType IsAnOption(const std::string &str) {
             if (str.size() == 2 && str.front() == '-' && Utils::IsALetter(str.at(1))) {
                 return OptionNameType::OPT_SHORT_NAME;
             } else if (str.size() > 2 && str.substr(0, 2) == "--" && Utils::IsALetter(str.at(2))) {
@@ -89,6 +191,128 @@ namespace ns_flags {
             }
         }
 
+        /**
+         * @brief a bit set over the dense ids of the options, all the masks of a parser are resized to
+         * the count of its options when the schema is finalized, so they are combined without any allocation
+         */
+        struct OptionMask {
+        public:
+            std::vector<std::uint64_t> words;
+
+        public:
+            /**
+             * @brief make room for the ids in [0, count), it allocates only if the mask grows
+             */
+            void Resize(std::size_t count) {
+                if (words.size() < (count + 63) / 64) { words.resize((count + 63) / 64, 0); }
+            }
+
+            void Reset() {
+                std::fill(words.begin(), words.end(), 0);
+            }
+
+            void Set(std::size_t id) {
+                words[id / 64] |= std::uint64_t(1) << (id % 64);
+            }
+
+            [[nodiscard]] bool Test(std::size_t id) const {
+                return id / 64 < words.size() && (words[id / 64] >> (id % 64) & 1);
+            }
+
+            [[nodiscard]] std::size_t Count() const {
+                std::size_t count = 0;
+                for (auto word: words) { count += PopCount(word); }
+                return count;
+            }
+
+            /**
+             * @brief the count of the ids in both masks
+             */
+            [[nodiscard]] std::size_t CountAnd(const OptionMask &other) const {
+                std::size_t count = 0;
+                for (std::size_t i = 0; i != std::min(words.size(), other.words.size()); ++i) {
+                    count += PopCount(words[i] & other.words[i]);
+                }
+                return count;
+            }
+
+            /**
+             * @brief visit the ids in this mask but not in the other one in ascending order
+             */
+            template<class Visitor>
+            void ForEachAndNot(const OptionMask &other, Visitor visitor) const {
+                for (std::size_t i = 0; i != words.size(); ++i) {
+                    auto word = i < other.words.size() ? words[i] & ~other.words[i] : words[i];
+                    for (; word != 0; word &= word - 1) {
+                        visitor(i * 64 + LowestBit(word));
+                    }
+                }
+            }
+
+            [[nodiscard]] std::vector<std::size_t> Ids() const {
+                return IdsAndNot(OptionMask());
+            }
+
+            /**
+             * @brief the ids in this mask but not in the other one
+             */
+            [[nodiscard]] std::vector<std::size_t> IdsAndNot(const OptionMask &other) const {
+                std::vector<std::size_t> ids;
+                ForEachAndNot(other, [&ids](std::size_t id) { ids.push_back(id); });
+                return ids;
+            }
+
+            /**
+             * @brief the ids in both masks
+             */
+            [[nodiscard]] std::vector<std::size_t> IdsAnd(const OptionMask &other) const {
+                std::vector<std::size_t> ids;
+                for (std::size_t i = 0; i != std::min(words.size(), other.words.size()); ++i) {
+                    for (auto word = words[i] & other.words[i]; word != 0; word &= word - 1) {
+                        ids.push_back(i * 64 + LowestBit(word));
+                    }
+                }
+                return ids;
+            }
+
+        protected:
+            // a single instruction each on the targets with 'popcnt' and 'tzcnt'
+            static std::size_t PopCount(std::uint64_t word) {
+                return static_cast<std::size_t>(__builtin_popcountll(word));
+            }
+
+            // the index of the lowest set bit, the word shouldn't be zero
+            static std::size_t LowestBit(std::uint64_t word) {
+                return static_cast<std::size_t>(__builtin_ctzll(word));
+            }
+        };
+
+        enum class ConstraintType {
+            // at most one option in the group is used
+            AT_MOST_ONE,
+            // exactly one option in the group is used
+            EXACTLY_ONE,
+            // if the option is used, all the options in the group should be used
+            REQUIRES
+        };
+
+        struct Constraint {
+            ConstraintType type;
+            // the option which requires the group, only for 'ConstraintType::REQUIRES'
+            std::size_t optionId;
+            OptionMask group;
+        };
+
+        /**
+         * @brief reloads the value of a reloadable option at runtime
+         */
+        struct Reloader {
+            // creates a new argument to receive the reloaded argv(s)
+            std::function<std::shared_ptr<Argument>()> create;
+            // publishes the validated argument to the readers
+            std::function<void(const std::shared_ptr<Argument> &)> publish;
+        };
+
         struct Option {
         public:
             using assertor_type = std::function<std::optional<std::string>(const std::shared_ptr<Argument> &)>;
@@ -107,6 +331,10 @@ namespace ns_flags {
             const OptionProp property;
             // assertor
             assertor_type assertor;
+            // it's nullptr if this option isn't reloadable
+            std::shared_ptr<Reloader> reloader;
+            // the dense id of this option in the parser, used by the constraint masks
+            std::size_t id = 0;
         private:
             const char EMPTY_OPTION_SHORT_NAME = '\0';
 
@@ -135,9 +363,16 @@ namespace ns_flags {
              * @brief assertor for the variable's value
              */
             void AssertOptionValue() const {
+                AssertOptionValue(this->variable.value);
+            }
+
+            /**
+             * @brief assertor for the given value of this option
+             */
+            void AssertOptionValue(const std::shared_ptr<Argument> &value) const {
                 if (this->assertor == nullptr) { return; }
 
-                if (auto msg = this->assertor(this->variable.value);msg) {
+                if (auto msg = this->assertor(value);msg) {
                     FLAGS_THROW_EXCEPTION(
                             AssertOptionValue,
                             "the value(s) for option " + GetOptionName() + " is(are) invalid: \"" + *msg + "\""
@@ -148,19 +383,7 @@ namespace ns_flags {
             /**
              * @brief override operator '<<' for type 'Option'
              */
-            friend std::ostream &operator<<(std::ostream &os, const Option &obj) {
-                os << std::boolalpha;
-                os << '{';
-                os << "'optionLongName': \"" << obj.optionLongName << "\", ";
-                os << "'optionShortName': \"" << obj.optionShortName << "\", ";
-                os << obj.variable << ", ";
-                os << "'desc': \"" << obj.description << "\", ";
-                os << "'prop': " << obj.property << ", ";
-                os << "'argType': " << obj.variable.defaultValue->TypeNameString() << ", ";
-                os << "'hasAssertor': " << (obj.assertor != nullptr);
-                os << '}';
-                return os;
-            };
+            friend FLAGS_INLINE std::ostream &operator<<(std::ostream &os, const Option &obj);
         };
     }
 
@@ -169,12 +392,32 @@ namespace ns_flags {
         template<class ArgumentType>
         using assertor_type = std::function<std::optional<std::string>(const typename ArgumentType::data_type &)>;
 
+        // computes the default value of a lazy option
+        template<class ArgumentType>
+        using thunk_type = std::function<typename ArgumentType::data_type()>;
+
+        // registers the options of a subcommand into the parser of this subcommand
+        using registrar_type = std::function<void(OptionParser &)>;
+
+        // invoked with 'true' when a phase of 'SetupFlags' begins, and with 'false' when it ends
+        using phase_observer_type = ns_priv::PhaseScope::observer_type;
+
+    private:
+        struct Subcommand {
+            std::string description;
+            registrar_type registrar;
+            // created when this subcommand is selected for the first time
+            std::shared_ptr<OptionParser> parser;
+        };
+
     private:
         // Determine whether to automatically generate corresponding content
         // If the user explicitly sets the corresponding content, we refuse to generate it automatically
         bool _autoGenHelpDocs;
         bool _autoGenVersion;
+        bool _builtinOptionsAdded;
         const std::string DEFAULT_OPTION_LONG_NAME = "def-opt";
+        const std::string COMPLETE_COMMAND = "__complete";
         const char EMPTY_OPTION_SHORT_NAME = '\0';
         std::string _progDescription;
 
@@ -182,13 +425,26 @@ namespace ns_flags {
         std::unordered_map<std::string, ns_priv::Option> _optLongNameToOpt;
         std::unordered_map<char, std::string> _optShortNameToOptLongName;
 
+        // subcommands, they are sorted by name in the help docs
+        std::unordered_map<std::string, Subcommand> _subcommands;
+        std::string _selectedSubcommand;
+
+        // the constraints compiled into the masks over the option ids
+        std::vector<std::string> _optIdToOptLongName;
+        ns_priv::OptionMask _requiredMask;
+        ns_priv::OptionMask _lazyDefaultMask;
+        // the options passed in, reused by the parses
+        ns_priv::OptionMask _presentMask;
+        std::vector<ns_priv::Constraint> _constraints;
+
+        // the sorted option long names for the prefix lookups of the completion, built on demand
+        std::vector<std::string> _optLongNameIndex;
+
+        phase_observer_type _phaseObserver;
+
     public:
-        OptionParser() : _autoGenHelpDocs(true), _autoGenVersion(true) {
-            // add help and version options
-            // Note that the address corresponding to the variable is nullptr
-            AddOption<Version>("version", 'v', "", "show the version message and exit", OptionProp::OPTIONAL, nullptr);
-            AddOption<Version>("help", 'h', "", "show this help message and exit", OptionProp::OPTIONAL, nullptr);
-        }
+        // nothing is allocated here, the help and version options are added on the first use
+        OptionParser() : _autoGenHelpDocs(true), _autoGenVersion(true), _builtinOptionsAdded(false) {}
 
         const std::unordered_map<std::string, ns_priv::Option> &GetOptionMap() const {
             return _optLongNameToOpt;
@@ -217,117 +473,124 @@ namespace ns_flags {
             _progDescription = progDesc;
         }
 
-        void SetProgDescriptionFromFile(const std::string &filename) {
-            std::ifstream file(filename, std::ios::in);
-            _progDescription = Utils::ReadStringFromFile(file);
-            file.close();
+        void SetProgDescriptionFromFile(const std::string &filename);
+
+        /**
+         * @brief Set the observer of the phases of 'SetupFlags', e.g. to count the allocations per phase
+         */
+        void SetPhaseObserver(phase_observer_type observer) {
+            _phaseObserver = std::move(observer);
         }
 
         /**
-         * @brief set up the option parser
+         * @brief at most one of the options can be used
+         */
+        void AddMutuallyExclusive(const std::vector<std::string> &optLongNames);
+
+        /**
+         * @brief exactly one of the options should be used
+         */
+        void AddExactlyOne(const std::vector<std::string> &optLongNames);
+
+        /**
+         * @brief if the option is used, all the required options should be used as well
+         */
+        void AddRequirement(const std::string &optLongName, const std::vector<std::string> &requiredOptLongNames);
+
+        /**
+         * @brief get the completion candidates for the last argv, which may be partial or empty. It's
+         * also invoked by 'SetupFlags' if the first argv is '__complete', then the candidates are thrown
+         * like the help docs, one per line. The help docs, conversions and assertors are all skipped
          *
-         * @param argc the count of the argument
-         * @param argv the value of the argument
+         * @param args the argv(s) after the program name
          */
-        void SetupFlags(int argc, char const *argv[]) {
-            if (this->_autoGenVersion) {
-                this->AutoGenVersion();
-            }
+        std::vector<std::string> Complete(const std::vector<std::string> &args);
 
-            if (this->_autoGenHelpDocs) {
-                this->AutoGenHelpDocs(argv[0]);
-            }
+        /**
+         * @brief generate a bash completion script, the top-level options and subcommands are listed
+         * statically, and the options of the subcommands are asked from '<program> __complete'
+         */
+        [[nodiscard]] std::string GenBashCompletion(const std::string &programName) const;
 
-            std::unordered_map<std::string, std::vector<std::string>> inputOptArgs;
-            std::string curOptLongName = DEFAULT_OPTION_LONG_NAME;
-
-            for (int i = 1; i != argc; ++i) {
-                std::string str = argv[i];
-                switch (ns_priv::IsAnOption(str)) {
-                    case ns_priv::OptionNameType::OPT_SHORT_NAME:
-                        if (auto optShortName = str.at(1);Utils::MapKeyExist(
-                                _optShortNameToOptLongName, optShortName)) {
-                            curOptLongName = _optLongNameToOpt.at(
-                                    _optShortNameToOptLongName.at(optShortName)).optionLongName;
-                            inputOptArgs[curOptLongName] = std::vector<std::string>();
-                            // is help or version options
-                            if (curOptLongName == "help") {
-                                throw std::runtime_error(GetHelpOption().variable.defaultValue->ValueString());
-                            } else if (curOptLongName == "version") {
-                                throw std::runtime_error(
-                                        std::string(argv[0]) + ": ['version': '" +
-                                        GetVersionOption().variable.defaultValue->ValueString() + "']"
-                                );
-                            }
-                        } else {
-                            FLAGS_THROW_EXCEPTION(SetupFlags, "there isn't option named \"-" + optShortName + "\"");
-                        }
-                        break;
-                    case ns_priv::OptionNameType::OPT_LONG_NAME:
-                        if (auto optLongName = str.substr(2);Utils::MapKeyExist(_optLongNameToOpt, optLongName)) {
-                            curOptLongName = optLongName;
-                            inputOptArgs[curOptLongName] = std::vector<std::string>();
-                            // is help or version options
-                            if (curOptLongName == "help") {
-                                throw std::runtime_error(GetHelpOption().variable.defaultValue->ValueString());
-                            } else if (curOptLongName == "version") {
-                                throw std::runtime_error(
-                                        std::string(argv[0]) + ": ['version': '" +
-                                        GetVersionOption().variable.defaultValue->ValueString() + "']"
-                                );
-                            }
-                        } else {
-                            FLAGS_THROW_EXCEPTION(SetupFlags, "there isn't option named \"--" + optLongName + "\"");
-                        }
-                        break;
-                    case ns_priv::OptionNameType::NONE:
-                        inputOptArgs[curOptLongName].push_back(str);
-                        break;
-                }
-            }
+        /**
+         * @brief generate a zsh completion script, see 'GenBashCompletion'
+         */
+        [[nodiscard]] std::string GenZshCompletion(const std::string &programName) const;
 
-            // the 'no-option' option is not set in the current program but user pass the 'no-option' argv(s)
-            // so we need to remove it.
-            if (!Utils::MapKeyExist(_optLongNameToOpt, DEFAULT_OPTION_LONG_NAME)) {
-                if (Utils::MapKeyExist(inputOptArgs, DEFAULT_OPTION_LONG_NAME)) {
-                    inputOptArgs.erase(DEFAULT_OPTION_LONG_NAME);
-                }
-            }
+        /**
+         * @brief reload the reloadable options from argv(s) like '--rate 10 --level 2', all the values are
+         * converted and asserted before any of them is published to both the handles and the parser
+         */
+        void Reload(const std::vector<std::string> &args);
 
-            // check whether any missing options have not been passed in according to the properties of the set options
-            for (const auto &[optLongName, opt]: _optLongNameToOpt) {
-                if (opt.property == OptionProp::OPTIONAL) {
-                    continue;
-                }
-                if (auto iter = inputOptArgs.find(optLongName);iter == inputOptArgs.cend()) {
-                    if (optLongName == DEFAULT_OPTION_LONG_NAME) {
-                        FLAGS_THROW_EXCEPTION(
-                                SetupFlags, "the default option is 'OptionProp::REQUIRED', but you didn't pass it"
-                        );
-                    } else {
-                        FLAGS_THROW_EXCEPTION(
-                                SetupFlags,
-                                "the option named " + opt.GetOptionName() +
-                                " is 'OptionProp::REQUIRED', but you didn't use it"
-                        );
-                    }
-                }
-            }
+        /**
+         * @brief reload the reloadable options from a file, whose content is argv(s) separated by white spaces
+         *
+         * @attention it's not async-signal-safe, on 'SIGHUP' set a flag in the handler and reload outside of it
+         */
+        void ReloadFromFile(const std::string &filename);
 
-            // assert and assign
-            for (const auto &[optLongName, inputArgs]: inputOptArgs) {
-                auto &opt = _optLongNameToOpt.find(optLongName)->second;
-                if (auto msg = opt.variable.value->DataFromStringVector(inputArgs);msg) {
-                    FLAGS_THROW_EXCEPTION(
-                            AssertOptionValue,
-                            "the value(s) for option " + optLongName + opt.GetOptionName() +
-                            " is(are) invalid: \"" + *msg + "\""
-                    );
-                }
-                opt.AssertOptionValue();
+        /**
+         * @brief add a subcommand, like 'train' in 'tool train --epochs 10'
+         *
+         * @param name the name of the subcommand
+         * @param description the description of the subcommand
+         * @param registrar registers the options of the subcommand, it's invoked only when the subcommand is selected
+         */
+        void AddSubcommand(const std::string &name, const std::string &description, registrar_type registrar) {
+            if (name.empty() || !Utils::IsALetter(name.front())) {
+                FLAGS_THROW_EXCEPTION_DEVELOPER(
+                        AddSubcommand, "the subcommand name should start with a letter. (for \"" + name + "\")"
+                );
+            }
+            if (registrar == nullptr) {
+                FLAGS_THROW_EXCEPTION_DEVELOPER(
+                        AddSubcommand, "the registrar of the subcommand \"" + name + "\" shouldn't be nullptr"
+                );
             }
+            if (_subcommands.find(name) != _subcommands.cend()) {
+                FLAGS_THROW_EXCEPTION_DEVELOPER(
+                        AddSubcommand, "the subcommand named \"" + name + "\" is exists already"
+                );
+            }
+            _subcommands.insert({name, Subcommand{description, std::move(registrar), nullptr}});
         }
 
+        /**
+         * @brief get the selected subcommand, it's empty if no subcommand is selected
+         */
+        [[nodiscard]] const std::string &GetSubcommand() const {
+            return _selectedSubcommand;
+        }
+
+        /**
+         * @brief set up the option parser
+         *
+         * @param argc the count of the argument
+         * @param argv the value of the argument
+         */
+        void SetupFlags(int argc, char const *argv[]) {
+            SetupFlags(argv[0], argc, argv);
+        }
+
+    protected:
+        /**
+         * @brief set up the option parser, 'argv[0]' is skipped and 'programName' is used instead
+         */
+        void SetupFlags(const std::string &programName, int argc, char const *argv[]);
+
+        /**
+         * @brief parse the options of this parser only, i.e., the argv(s) before the subcommand
+         */
+        void ParseOptions(const std::string &programName, int argc, char const *argv[]);
+
+        /**
+         * @brief get the parser of the subcommand, it's created and registered on the first use only,
+         * so the references handed out by the registrar stay valid
+         */
+        OptionParser &GetSubcommandParser(Subcommand &sub);
+
+    public:
         /**
          * @tparam ArgumentType the type of the option's argument
          *
@@ -345,50 +608,7 @@ namespace ns_flags {
         const typename ArgumentType::data_type &
         AddOption(const std::string &optionLongName, char optionShortName,
                   const typename ArgumentType::data_type &defaultValue, const std::string &description,
-                  const OptionProp &property, assertor_type<ArgumentType> assertor = nullptr) {
-            if (optionLongName.empty()) {
-                FLAGS_THROW_EXCEPTION_DEVELOPER(
-                        AddOption, "the option name shouldn't be a empty string"
-                );
-            }
-            if (!Utils::IsALetter(optionLongName.front())) {
-                FLAGS_THROW_EXCEPTION_DEVELOPER(
-                        AddOption,
-                        "the option long name should be capitalized. (for option \"--" + optionLongName + "\")"
-                );
-            }
-            if (optionShortName != EMPTY_OPTION_SHORT_NAME && !Utils::IsALetter(optionShortName)) {
-                FLAGS_THROW_EXCEPTION_DEVELOPER(
-                        AddOption,
-                        "the option short name should be capitalized. (for option \"-" + optionShortName + "\")"
-                );
-            }
-            if (Utils::MapKeyExist(_optLongNameToOpt, optionLongName)) {
-                FLAGS_THROW_EXCEPTION_DEVELOPER(
-                        AddOption, "the option named \"--" + optionLongName + "\" is exists already"
-                );
-            }
-            if (optionShortName != EMPTY_OPTION_SHORT_NAME &&
-                Utils::MapKeyExist(_optShortNameToOptLongName, optionShortName)) {
-                FLAGS_THROW_EXCEPTION_DEVELOPER(
-                        AddOption, "the option named \"-" + optionShortName + "\" is exists already"
-                );
-            }
-            ns_priv::Option::assertor_type tarAssertor = nullptr;
-            if (assertor) {
-                tarAssertor = [assertor](const std::shared_ptr<Argument> &obj) -> std::optional<std::string> {
-                    return assertor(obj->template Boost<ArgumentType>()->GetData());
-                };
-            }
-            auto option = ns_priv::Option(
-                    optionLongName, optionShortName, Variable::Create<ArgumentType>(defaultValue),
-                    description, property, tarAssertor
-            );
-            // save the option to map
-            _optLongNameToOpt.insert({optionLongName, option});
-            _optShortNameToOptLongName.insert({optionShortName, optionLongName});
-            return _optLongNameToOpt.at(optionLongName).variable.value->template Boost<ArgumentType>()->GetData();
-        }
+                  const OptionProp &property, assertor_type<ArgumentType> assertor = nullptr);
 
         /**
          * @tparam ArgumentType the type of the option's argument
@@ -412,6 +632,124 @@ namespace ns_flags {
             );
         }
 
+        /**
+         * @brief add an option whose default value is computed by a thunk, which is evaluated at most once,
+         * only when the option doesn't receive any value or the default value is printed
+         *
+         * @tparam ArgumentType the type of the option's argument
+         *
+         * @param optionLongName the option long name
+         * @param optionShortName the option short name
+         * @param defaultValue the thunk to compute the default value, like '[] { return DetectCoreCount(); }'
+         * @param description the description of this option
+         * @param property the property of this option
+         * @param assertor the assertor to judge whether the entered args are valid
+         * @return the value address of the option argument, which is valid after 'SetupFlags'
+         *
+         * @attention user should use reference to receive the return value
+         */
+        template<class ArgumentType>
+        const typename ArgumentType::data_type &
+        AddLazyOption(const std::string &optionLongName, char optionShortName,
+                      thunk_type<ArgumentType> defaultValue, const std::string &description,
+                      const OptionProp &property, assertor_type<ArgumentType> assertor = nullptr) {
+            return AddOptionVariable<ArgumentType>(
+                    optionLongName, optionShortName, Variable::CreateLazy<ArgumentType>(std::move(defaultValue)),
+                    description, property, assertor
+            );
+        }
+
+        /**
+         * @brief add an option whose default value is computed by a thunk, see the overload above
+         */
+        template<class ArgumentType>
+        const typename ArgumentType::data_type &
+        AddLazyOption(const std::string &optLongName, thunk_type<ArgumentType> defaultValue,
+                      const std::string &description, const OptionProp &property,
+                      assertor_type<ArgumentType> assertor = nullptr) {
+            return AddLazyOption<ArgumentType>(
+                    optLongName, EMPTY_OPTION_SHORT_NAME, std::move(defaultValue), description, property, assertor
+            );
+        }
+
+        /**
+         * @brief add an option whose value is written straight into a member of the user's object,
+         * the initial value of the member is the default value
+         *
+         * @tparam ArgumentType the type of the option's argument
+         *
+         * @param object the object to receive the value, which should outlive the parser
+         * @param member the member of the object, like '&Config::threads'
+         * @param optionLongName the option long name
+         * @param optionShortName the option short name
+         * @param description the description of this option
+         * @param property the property of this option
+         * @param assertor the assertor to judge whether the entered args are valid
+         * @return the member of the object
+         */
+        template<class ArgumentType, class StructType>
+        const typename ArgumentType::data_type &
+        Bind(StructType &object, typename ArgumentType::data_type StructType::*member,
+             const std::string &optionLongName, char optionShortName, const std::string &description,
+             const OptionProp &property, assertor_type<ArgumentType> assertor = nullptr) {
+            return AddOptionVariable<Bound<ArgumentType>>(
+                    optionLongName, optionShortName, Variable::CreateBound<ArgumentType>(object.*member),
+                    description, property, assertor
+            );
+        }
+
+        /**
+         * @brief add an option whose value is written straight into a member of the user's object,
+         * see the overload above
+         */
+        template<class ArgumentType, class StructType>
+        const typename ArgumentType::data_type &
+        Bind(StructType &object, typename ArgumentType::data_type StructType::*member,
+             const std::string &optionLongName, const std::string &description,
+             const OptionProp &property, assertor_type<ArgumentType> assertor = nullptr) {
+            return Bind<ArgumentType>(
+                    object, member, optionLongName, EMPTY_OPTION_SHORT_NAME, description, property, assertor
+            );
+        }
+
+        /**
+         * @brief add an option whose value can be reloaded at runtime by 'Reload' or 'ReloadFromFile'
+         *
+         * @tparam ArgumentType the type of the option's argument
+         *
+         * @param optionLongName the option long name
+         * @param optionShortName the option short name
+         * @param defaultValue the default value of the option argument
+         * @param description the description of this option
+         * @param property the property of this option
+         * @param assertor the assertor to judge whether the entered args are valid
+         * @return the handle to read the snapshots of the value
+         *
+         * @attention user should use reference to receive the return value, and 'reloadable.hpp' should be included
+         */
+        template<class ArgumentType>
+        const Reloadable<typename ArgumentType::data_type> &
+        AddReloadableOption(const std::string &optionLongName, char optionShortName,
+                            const typename ArgumentType::data_type &defaultValue, const std::string &description,
+                            const OptionProp &property, assertor_type<ArgumentType> assertor = nullptr) {
+            AddOption<ArgumentType>(optionLongName, optionShortName, defaultValue, description, property, assertor);
+            auto handle = std::make_shared<Reloadable<typename ArgumentType::data_type>>(defaultValue);
+            auto reloader = std::make_shared<ns_priv::Reloader>();
+            reloader->create = [defaultValue]() -> std::shared_ptr<Argument> {
+                return std::make_shared<ArgumentType>(defaultValue);
+            };
+            auto &option = _optLongNameToOpt.at(optionLongName);
+            // the reloader owns the handle, which lives as long as the option, and the value of the option
+            // is updated too, so the printing and the sharing of the options see the reloaded value
+            reloader->publish = [handle, value = option.variable.value](const std::shared_ptr<Argument> &arg) {
+                const auto &data = arg->template Boost<ArgumentType>()->GetData();
+                value->template Boost<ArgumentType>()->SetData(data);
+                handle->Publish(data);
+            };
+            option.reloader = reloader;
+            return *handle;
+        }
+
         /**
          * @tparam ArgumentType the type of the option's argument
          *
@@ -432,77 +770,64 @@ namespace ns_flags {
         }
 
     protected:
-        ns_priv::Option GetVersionOption() { return _optLongNameToOpt.at("version"); }
+        ns_priv::Option &GetVersionOption() {
+            AddBuiltinOptions();
+            return _optLongNameToOpt.at("version");
+        }
 
-        ns_priv::Option GetHelpOption() { return _optLongNameToOpt.at("help"); }
+        ns_priv::Option &GetHelpOption() {
+            AddBuiltinOptions();
+            return _optLongNameToOpt.at("help");
+        }
 
-        void AutoGenHelpDocs(const std::string &programName) {
-            std::stringstream stream;
+        /**
+         * @brief add the help and version options if they haven't been added
+         */
+        void AddBuiltinOptions() {
+            if (_builtinOptionsAdded) { return; }
+            _builtinOptionsAdded = true;
+            // the version is generated here, unless it's set by the user
+            AddOption<Version>("version", 'v', "1.0.0", "show the version message and exit", OptionProp::OPTIONAL, nullptr);
+            AddOption<Version>("help", 'h', "", "show this help message and exit", OptionProp::OPTIONAL, nullptr);
+        }
 
-            // program description
-            if (!_progDescription.empty()) {
-                stream << _progDescription << "\n\n";
-            }
+        void AutoGenHelpDocs(const std::string &programName);
 
-            // the main usage of this program
-            stream << "Usage: " << programName;
-            if (Utils::MapKeyExist(_optLongNameToOpt, DEFAULT_OPTION_LONG_NAME)) {
-                stream << " [def-opt argv(s)]";
-            }
-            stream << " [opt-name argv(s)] ...\n\n";
-
-            // the header of the help docs
-            stream << "    " << std::setw(15) << std::left << "Options"
-                   << std::setw(15) << std::left << "Property"
-                   << std::setw(15) << std::left << "Type"
-                   << "Describes\n";
-            stream << std::string(62, '-') << '\n';
-
-            if (Utils::MapKeyExist(_optLongNameToOpt, DEFAULT_OPTION_LONG_NAME)) {
-                auto &nopt = _optLongNameToOpt.at(DEFAULT_OPTION_LONG_NAME);
-                stream << "  --" << std::setw(15) << std::left << "def-opt"
-                       << std::setw(15) << std::left << nopt.property
-                       << std::setw(15) << std::left << nopt.variable.defaultValue->TypeNameString()
-                       << nopt.description << "\n\n";
-            }
+        [[noreturn]] void ThrowHelpDocs(const std::string &programName);
 
-            for (const auto &elem: _optLongNameToOpt) {
-                if (elem.first == "help" || elem.first == "version" || elem.first == DEFAULT_OPTION_LONG_NAME) {
-                    continue;
-                }
-                if (elem.second.optionShortName != EMPTY_OPTION_SHORT_NAME) {
-                    stream << "  --" << std::setw(15) << std::left
-                           << elem.second.optionLongName + ", -" + elem.second.optionShortName;
-                } else {
-                    stream << "  --" << std::setw(15) << std::left << elem.second.optionLongName;
-                }
-                stream << std::setw(15) << std::left << elem.second.property
-                       << std::setw(15) << std::left << elem.second.variable.defaultValue->TypeNameString()
-                       << elem.second.description << '\n';
-            }
+        /**
+         * @brief check the names and add the option with the created variable
+         */
+        template<class ArgumentType>
+        const typename ArgumentType::data_type &
+        AddOptionVariable(const std::string &optionLongName, char optionShortName, Variable variable,
+                          const std::string &description, const OptionProp &property,
+                          assertor_type<ArgumentType> assertor);
 
-            // help and version
-            auto &help = _optLongNameToOpt.at("help");
-            auto &version = _optLongNameToOpt.at("version");
-            stream << "\n  --" << std::setw(15) << std::left << help.optionLongName + ", -" + help.optionShortName
-                   << std::setw(15) << std::left << help.property
-                   << std::setw(15) << std::left << help.variable.defaultValue->TypeNameString()
-                   << help.description;
-            stream << "\n  --" << std::setw(15) << std::left << version.optionLongName + ", -" + version.optionShortName
-                   << std::setw(15) << std::left << version.property
-                   << std::setw(15) << std::left << version.variable.defaultValue->TypeNameString()
-                   << version.description;
+        /**
+         * @brief compile the option names to a mask
+         */
+        [[nodiscard]] ns_priv::OptionMask OptionNamesToMask(const std::vector<std::string> &optLongNames) const;
 
-            // suffix
-            stream << "\n\nhelp docs for program \"" + programName + "\"";
+        /**
+         * @brief list the names of the options in the mask, used by the error messages
+         */
+        [[nodiscard]] std::string MaskToOptionNames(const std::vector<std::size_t> &ids) const;
 
-            // assign
-            GetHelpOption().variable.defaultValue->DataFromStringVector({stream.str()});
-        }
+        /**
+         * @brief resize all the masks to the count of the options, it allocates only if options are added
+         */
+        void FinalizeMasks();
 
-        void AutoGenVersion() {
-            GetVersionOption().variable.defaultValue->DataFromStringVector({"1.0.0"});
-        }
+        /**
+         * @brief check the required options and the constraints with the options passed in
+         */
+        void CheckConstraints(const ns_priv::OptionMask &present) const;
+
+        /**
+         * @brief the words which can be completed statically, i.e., the subcommands and the option names
+         */
+        [[nodiscard]] std::string StaticCompletionWords() const;
 
     private:
 
@@ -513,24 +838,132 @@ namespace ns_flags {
         /**
          * @brief override operator '<<' for type 'Option'
          */
-        friend std::ostream &operator<<(std::ostream &os, const OptionParser &obj) {
-            for (const auto &[optionName, option]: obj.GetOptionMap()) {
-                if (optionName == "help" || optionName == "version") {
-                    auto tmpOption = option;
-                    tmpOption.variable.defaultValue->DataFromStringVector({"\"...\""});
-                    tmpOption.variable.value->DataFromStringVector({"\"...\""});
-                    os << option << std::endl;
-                } else {
-                    os << option << std::endl;
-                }
-            }
-            return os;
+        friend FLAGS_INLINE std::ostream &operator<<(std::ostream &os, const OptionParser &obj);
+    };
+
+    template<class ArgumentType>
+    const typename ArgumentType::data_type &
+    OptionParser::AddOption(const std::string &optionLongName, char optionShortName,
+                            const typename ArgumentType::data_type &defaultValue, const std::string &description,
+                            const OptionProp &property, assertor_type<ArgumentType> assertor) {
+        return AddOptionVariable<ArgumentType>(
+                optionLongName, optionShortName, Variable::Create<ArgumentType>(defaultValue),
+                description, property, assertor
+        );
+    }
+
+    template<class ArgumentType>
+    const typename ArgumentType::data_type &
+    OptionParser::AddOptionVariable(const std::string &optionLongName, char optionShortName, Variable variable,
+                                    const std::string &description, const OptionProp &property,
+                                    assertor_type<ArgumentType> assertor) {
+        AddBuiltinOptions();
+        if (optionLongName.empty()) {
+            FLAGS_THROW_EXCEPTION_DEVELOPER(
+                    AddOption, "the option name shouldn't be a empty string"
+            );
+        }
+        if (!Utils::IsALetter(optionLongName.front())) {
+            FLAGS_THROW_EXCEPTION_DEVELOPER(
+                    AddOption,
+                    "the option long name should be capitalized. (for option \"--" + optionLongName + "\")"
+            );
+        }
+        if (optionShortName != EMPTY_OPTION_SHORT_NAME && !Utils::IsALetter(optionShortName)) {
+            FLAGS_THROW_EXCEPTION_DEVELOPER(
+                    AddOption,
+                    "the option short name should be capitalized. (for option \"-" + optionShortName + "\")"
+            );
+        }
+        if (Utils::MapKeyExist(_optLongNameToOpt, optionLongName)) {
+            FLAGS_THROW_EXCEPTION_DEVELOPER(
+                    AddOption, "the option named \"--" + optionLongName + "\" is exists already"
+            );
+        }
+        if (optionShortName != EMPTY_OPTION_SHORT_NAME &&
+            Utils::MapKeyExist(_optShortNameToOptLongName, optionShortName)) {
+            FLAGS_THROW_EXCEPTION_DEVELOPER(
+                    AddOption, "the option named \"-" + optionShortName + "\" is exists already"
+            );
+        }
+        ns_priv::Option::assertor_type tarAssertor = nullptr;
+        if (assertor) {
+            tarAssertor = [assertor](const std::shared_ptr<Argument> &obj) -> std::optional<std::string> {
+                return assertor(obj->template Boost<ArgumentType>()->GetData());
+            };
+        }
+        auto option = ns_priv::Option(
+                optionLongName, optionShortName, std::move(variable), description, property, tarAssertor
+        );
+        option.id = _optIdToOptLongName.size();
+        _optIdToOptLongName.push_back(optionLongName);
+        if (property == OptionProp::REQUIRED) {
+            _requiredMask.Resize(option.id + 1);
+            _requiredMask.Set(option.id);
+        }
+        if (option.variable.lazyDefault != nullptr) {
+            _lazyDefaultMask.Resize(option.id + 1);
+            _lazyDefaultMask.Set(option.id);
         }
-    } parser;
+        // save the option to map
+        _optLongNameToOpt.insert({optionLongName, option});
+        _optShortNameToOptLongName.insert({optionShortName, optionLongName});
+        _optLongNameIndex.clear();
+        return _optLongNameToOpt.at(optionLongName).variable.value->template Boost<ArgumentType>()->GetData();
+    }
+
+    // the argument types shipped with lib-flags, they are instantiated once in the compiled library
+#define FLAGS_ADD_OPTION_INSTANTIATION(Prefix, ArgType)                                                 \
+  Prefix const ArgType::data_type &OptionParser::AddOption<ArgType>(                                    \
+      const std::string &, char, const ArgType::data_type &, const std::string &, const OptionProp &, \
+      OptionParser::assertor_type<ArgType>);                                                          \
+  Prefix const ArgType::data_type &OptionParser::AddOptionVariable<ArgType>(                            \
+      const std::string &, char, Variable, const std::string &, const OptionProp &,                   \
+      OptionParser::assertor_type<ArgType>);
+
+#define FLAGS_ADD_OPTION_INSTANTIATIONS(Prefix)         \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, Int)             \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, IntVec)          \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, Bool)            \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, BoolVec)         \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, Float)           \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, FloatVec)        \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, Double)          \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, DoubleVec)       \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, String)          \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, StringVec)       \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, Help)            \
+  FLAGS_ADD_OPTION_INSTANTIATION(Prefix, Version)
+
+#ifdef FLAGS_COMPILED_LIB
+    FLAGS_ADD_OPTION_INSTANTIATIONS(extern template)
+#endif
+
+    /**
+     * @brief get the only global parser, which is constructed on the first call
+     *
+     * @attention use it instead of 'parser' in the initializers of the static variables
+     */
+    FLAGS_INLINE OptionParser &GetParser();
+
+    // the same instance in all the translation units, this initialization constructs the parser in the
+    // static initialization of every program including this header, which allocates nothing
+    inline OptionParser &parser = GetParser();
+}
+
+#if !defined(FLAGS_COMPILED_LIB) || defined(FLAGS_COMPILED_LIB_BUILD)
+
+#include "flags_impl.hpp"
 
+#endif
+
+#ifndef FLAGS_COMPILED_LIB_BUILD
 #undef FLAGS_THROW_EXCEPTION
 #undef FLAGS_THROW_EXCEPTION_DEVELOPER
-}
+#undef FLAGS_ADD_OPTION_INSTANTIATION
+#undef FLAGS_ADD_OPTION_INSTANTIATIONS
+#undef FLAGS_INLINE
+#endif
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,762 @@
+/**
+ * @file flags_impl.hpp
+ * @brief the definitions of the non-template members of 'OptionParser' and 'Utils', and of the stream operators,
+ * this file shouldn't be included directly, it's included by 'flags.hpp' in the header-only mode and compiled
+ * into the 'flags' library otherwise
+ */
+
+#ifndef FLAGS_FLAGS_IMPL_HPP
+#define FLAGS_FLAGS_IMPL_HPP
+
+#include "flags.hpp"
+#include "iostream"
+#include "sstream"
+#include "fstream"
+#include "iomanip"
+
+namespace ns_flags {
+
+    FLAGS_INLINE std::string Utils::ReadStringFromFile(std::istream &file) {
+        file.seekg(0, std::ios::end);
+        auto size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        std::string str(size, ' ');
+        file.read(const_cast<char *>(str.c_str()), size);
+        return str;
+    }
+
+    FLAGS_INLINE std::string Utils::ToString(bool data) {
+        return ToString<bool, std::ostringstream>(data);
+    }
+
+    FLAGS_INLINE std::string Utils::ToString(int data) {
+        return ToString<int, std::ostringstream>(data);
+    }
+
+    FLAGS_INLINE std::string Utils::ToString(float data) {
+        return ToString<float, std::ostringstream>(data);
+    }
+
+    FLAGS_INLINE std::string Utils::ToString(double data) {
+        return ToString<double, std::ostringstream>(data);
+    }
+
+    FLAGS_INLINE std::string Utils::ToString(const std::string &data) {
+        return data;
+    }
+
+    FLAGS_INLINE std::string Utils::ToString(const std::vector<bool> &data) {
+        return ToString<std::vector<bool>, std::ostringstream>(data);
+    }
+
+    FLAGS_INLINE std::string Utils::ToString(const std::vector<int> &data) {
+        return ToString<std::vector<int>, std::ostringstream>(data);
+    }
+
+    FLAGS_INLINE std::string Utils::ToString(const std::vector<float> &data) {
+        return ToString<std::vector<float>, std::ostringstream>(data);
+    }
+
+    FLAGS_INLINE std::string Utils::ToString(const std::vector<double> &data) {
+        return ToString<std::vector<double>, std::ostringstream>(data);
+    }
+
+    FLAGS_INLINE std::string Utils::ToString(const std::vector<std::string> &data) {
+        return ToString<std::vector<std::string>, std::ostringstream>(data);
+    }
+
+    FLAGS_INLINE std::ostream &Utils::PrintArgument(std::ostream &os, const std::string &typeName,
+                                                    const std::string &value) {
+        os << typeName << "{data: " << value << '}';
+        return os;
+    }
+
+    FLAGS_INLINE std::ostream &operator<<(std::ostream &os, const OptionProp &obj) {
+        switch (obj) {
+            case OptionProp::OPTIONAL:
+                os << "Optional";
+                break;
+            case OptionProp::REQUIRED:
+                os << "Required";
+                break;
+        }
+        return os;
+    }
+
+    FLAGS_INLINE std::ostream &operator<<(std::ostream &os, const ParsePhase &obj) {
+        switch (obj) {
+            case ParsePhase::TOKENIZE:
+                os << "Tokenize";
+                break;
+            case ParsePhase::CONSTRAINT:
+                os << "Constraint";
+                break;
+            case ParsePhase::CONVERT:
+                os << "Convert";
+                break;
+            case ParsePhase::ASSERT:
+                os << "Assert";
+                break;
+            case ParsePhase::RESOLVE:
+                os << "Resolve";
+                break;
+            case ParsePhase::PUBLISH:
+                os << "Publish";
+                break;
+            case ParsePhase::HELP:
+                os << "Help";
+                break;
+        }
+        return os;
+    }
+
+    FLAGS_INLINE std::ostream &operator<<(std::ostream &os, const Variable &variable) {
+        variable.ResolveDefault();
+        os << "'defaultValue': " << variable.defaultValue->ValueString()
+           << ", 'value': " << variable.value->ValueString();
+        return os;
+    }
+
+    namespace ns_priv {
+        FLAGS_INLINE std::ostream &operator<<(std::ostream &os, const Option &obj) {
+            os << std::boolalpha;
+            os << '{';
+            os << "'optionLongName': \"" << obj.optionLongName << "\", ";
+            os << "'optionShortName': \"" << obj.optionShortName << "\", ";
+            os << obj.variable << ", ";
+            os << "'desc': \"" << obj.description << "\", ";
+            os << "'prop': " << obj.property << ", ";
+            os << "'argType': " << obj.variable.defaultValue->TypeNameString() << ", ";
+            os << "'hasAssertor': " << (obj.assertor != nullptr) << ", ";
+            os << "'reloadable': " << (obj.reloader != nullptr);
+            os << '}';
+            return os;
+        }
+    }
+
+    FLAGS_INLINE std::ostream &operator<<(std::ostream &os, const OptionParser &obj) {
+        for (const auto &[optionName, option]: obj.GetOptionMap()) {
+            if (optionName == "help" || optionName == "version") {
+                auto tmpOption = option;
+                tmpOption.variable.defaultValue->DataFromStringVector({"\"...\""});
+                tmpOption.variable.value->DataFromStringVector({"\"...\""});
+                os << option << std::endl;
+            } else {
+                os << option << std::endl;
+            }
+        }
+        return os;
+    }
+
+    FLAGS_INLINE OptionParser &GetParser() {
+        static OptionParser instance;
+        return instance;
+    }
+
+    FLAGS_INLINE void OptionParser::SetProgDescriptionFromFile(const std::string &filename) {
+        std::ifstream file(filename, std::ios::in);
+        _progDescription = Utils::ReadStringFromFile(file);
+        file.close();
+    }
+
+    FLAGS_INLINE void OptionParser::SetupFlags(const std::string &programName, int argc, char const *argv[]) {
+        AddBuiltinOptions();
+
+        // answer the shell completion as fast as possible
+        if (argc > 1 && argv[1] == COMPLETE_COMMAND) {
+            std::string candidates;
+            for (const auto &candidate: Complete(std::vector<std::string>(argv + 2, argv + argc))) {
+                candidates += candidate + '\n';
+            }
+            throw std::runtime_error(candidates);
+        }
+
+        // the first argv naming a subcommand selects it, the argv(s) before it belong to the top level,
+        // and only the options of the selected subcommand are registered. The argv right after an option
+        // name is the value of this option, e.g. 'train' in '--mode train', so it's never a subcommand
+        int subArgIdx = argc;
+        bool afterOptionName = false;
+        for (int i = 1; i != argc; ++i) {
+            if (ns_priv::IsAnOption(argv[i]) != ns_priv::OptionNameType::NONE) {
+                afterOptionName = true;
+                continue;
+            }
+            if (!afterOptionName && _subcommands.find(argv[i]) != _subcommands.end()) {
+                subArgIdx = i;
+                break;
+            }
+            afterOptionName = false;
+        }
+        if (subArgIdx == argc && argc > 1 && !_subcommands.empty() &&
+            ns_priv::IsAnOption(argv[1]) == ns_priv::OptionNameType::NONE &&
+            !Utils::MapKeyExist(_optLongNameToOpt, DEFAULT_OPTION_LONG_NAME)) {
+            FLAGS_THROW_EXCEPTION(SetupFlags, "there isn't subcommand named \"" + std::string(argv[1]) + "\"");
+        }
+
+        ParseOptions(programName, subArgIdx, argv);
+
+        _selectedSubcommand.clear();
+        if (subArgIdx != argc) {
+            auto &[name, sub] = *_subcommands.find(argv[subArgIdx]);
+            _selectedSubcommand = name;
+            auto &subParser = GetSubcommandParser(sub);
+            subParser.SetPhaseObserver(_phaseObserver);
+            subParser.SetupFlags(programName + " " + name, argc - subArgIdx, argv + subArgIdx);
+        }
+    }
+
+    FLAGS_INLINE OptionParser &OptionParser::GetSubcommandParser(Subcommand &sub) {
+        if (sub.parser == nullptr) {
+            sub.parser = std::make_shared<OptionParser>();
+            sub.parser->SetProgDescription(sub.description);
+            if (!this->_autoGenVersion) {
+                sub.parser->SetVersion(GetVersionOption().variable.defaultValue->ValueString());
+            }
+            sub.registrar(*sub.parser);
+        }
+        return *sub.parser;
+    }
+
+    FLAGS_INLINE void OptionParser::ParseOptions(const std::string &programName, int argc, char const *argv[]) {
+        std::unordered_map<std::string, std::vector<std::string>> inputOptArgs;
+        std::string curOptLongName = DEFAULT_OPTION_LONG_NAME;
+        FinalizeMasks();
+        auto &present = _presentMask;
+        present.Reset();
+
+        auto tokenizeScope = ns_priv::PhaseScope(_phaseObserver, ParsePhase::TOKENIZE);
+        for (int i = 1; i != argc; ++i) {
+            std::string str = argv[i];
+            switch (ns_priv::IsAnOption(str)) {
+                case ns_priv::OptionNameType::OPT_SHORT_NAME:
+                    if (auto optShortName = str.at(1);Utils::MapKeyExist(
+                            _optShortNameToOptLongName, optShortName)) {
+                        const auto &opt = _optLongNameToOpt.at(_optShortNameToOptLongName.at(optShortName));
+                        curOptLongName = opt.optionLongName;
+                        inputOptArgs[curOptLongName] = std::vector<std::string>();
+                        present.Set(opt.id);
+                        // is help or version options
+                        if (curOptLongName == "help") {
+                            // the help docs are generated in their own phase
+                            tokenizeScope.Finish();
+                            ThrowHelpDocs(programName);
+                        } else if (curOptLongName == "version") {
+                            throw std::runtime_error(
+                                    programName + ": ['version': '" +
+                                    GetVersionOption().variable.defaultValue->ValueString() + "']"
+                            );
+                        }
+                    } else {
+                        FLAGS_THROW_EXCEPTION(SetupFlags, "there isn't option named \"-" + optShortName + "\"");
+                    }
+                    break;
+                case ns_priv::OptionNameType::OPT_LONG_NAME:
+                    if (auto iter = _optLongNameToOpt.find(str.substr(2));iter != _optLongNameToOpt.end()) {
+                        curOptLongName = iter->first;
+                        inputOptArgs[curOptLongName] = std::vector<std::string>();
+                        present.Set(iter->second.id);
+                        // is help or version options
+                        if (curOptLongName == "help") {
+                            // the help docs are generated in their own phase
+                            tokenizeScope.Finish();
+                            ThrowHelpDocs(programName);
+                        } else if (curOptLongName == "version") {
+                            throw std::runtime_error(
+                                    programName + ": ['version': '" +
+                                    GetVersionOption().variable.defaultValue->ValueString() + "']"
+                            );
+                        }
+                    } else {
+                        FLAGS_THROW_EXCEPTION(SetupFlags, "there isn't option named \"" + str + "\"");
+                    }
+                    break;
+                case ns_priv::OptionNameType::NONE:
+                    inputOptArgs[curOptLongName].push_back(str);
+                    break;
+            }
+        }
+
+        // the 'no-option' option is not set in the current program but user pass the 'no-option' argv(s)
+        // so we need to remove it.
+        if (auto iter = _optLongNameToOpt.find(DEFAULT_OPTION_LONG_NAME);iter == _optLongNameToOpt.end()) {
+            if (Utils::MapKeyExist(inputOptArgs, DEFAULT_OPTION_LONG_NAME)) {
+                inputOptArgs.erase(DEFAULT_OPTION_LONG_NAME);
+            }
+        } else if (Utils::MapKeyExist(inputOptArgs, DEFAULT_OPTION_LONG_NAME)) {
+            present.Set(iter->second.id);
+        }
+
+        tokenizeScope.Finish();
+
+        // check whether any missing options have not been passed in according to the properties of the set options
+        {
+            auto scope = ns_priv::PhaseScope(_phaseObserver, ParsePhase::CONSTRAINT);
+            CheckConstraints(present);
+        }
+
+        // assign
+        {
+            auto scope = ns_priv::PhaseScope(_phaseObserver, ParsePhase::CONVERT);
+            for (const auto &[optLongName, inputArgs]: inputOptArgs) {
+                auto &opt = _optLongNameToOpt.find(optLongName)->second;
+                // the lazy default value is needed only if the conversion keeps it, e.g. '--threads' without any value
+                if (inputArgs.empty() && opt.variable.value->KeepsDataOnEmptyInput()) {
+                    opt.variable.ResolveValue();
+                }
+                if (auto msg = opt.variable.value->DataFromStringVector(inputArgs);msg) {
+                    FLAGS_THROW_EXCEPTION(
+                            AssertOptionValue,
+                            "the value(s) for option " + optLongName + opt.GetOptionName() +
+                            " is(are) invalid: \"" + *msg + "\""
+                    );
+                }
+            }
+        }
+
+        // assert
+        {
+            auto scope = ns_priv::PhaseScope(_phaseObserver, ParsePhase::ASSERT);
+            for (const auto &[optLongName, inputArgs]: inputOptArgs) {
+                _optLongNameToOpt.find(optLongName)->second.AssertOptionValue();
+            }
+        }
+
+        // only the lazy default values of the options which are not passed in are evaluated
+        {
+            auto scope = ns_priv::PhaseScope(_phaseObserver, ParsePhase::RESOLVE);
+            _lazyDefaultMask.ForEachAndNot(present, [this](std::size_t id) {
+                _optLongNameToOpt.at(_optIdToOptLongName.at(id)).variable.ResolveValue();
+            });
+        }
+
+        // the reloadable options start from the parsed values
+        {
+            auto scope = ns_priv::PhaseScope(_phaseObserver, ParsePhase::PUBLISH);
+            for (const auto &[optLongName, inputArgs]: inputOptArgs) {
+                if (const auto &opt = _optLongNameToOpt.find(optLongName)->second;opt.reloader != nullptr) {
+                    opt.reloader->publish(opt.variable.value);
+                }
+            }
+        }
+    }
+
+    FLAGS_INLINE void OptionParser::AddMutuallyExclusive(const std::vector<std::string> &optLongNames) {
+        _constraints.push_back({ns_priv::ConstraintType::AT_MOST_ONE, 0, OptionNamesToMask(optLongNames)});
+    }
+
+    FLAGS_INLINE void OptionParser::AddExactlyOne(const std::vector<std::string> &optLongNames) {
+        _constraints.push_back({ns_priv::ConstraintType::EXACTLY_ONE, 0, OptionNamesToMask(optLongNames)});
+    }
+
+    FLAGS_INLINE void OptionParser::AddRequirement(const std::string &optLongName,
+                                                   const std::vector<std::string> &requiredOptLongNames) {
+        auto id = OptionNamesToMask({optLongName}).Ids().front();
+        _constraints.push_back({ns_priv::ConstraintType::REQUIRES, id, OptionNamesToMask(requiredOptLongNames)});
+    }
+
+    FLAGS_INLINE ns_priv::OptionMask OptionParser::OptionNamesToMask(const std::vector<std::string> &optLongNames) const {
+        ns_priv::OptionMask mask;
+        mask.Resize(_optIdToOptLongName.size());
+        for (const auto &optLongName: optLongNames) {
+            if (auto iter = _optLongNameToOpt.find(optLongName);iter != _optLongNameToOpt.cend()) {
+                mask.Set(iter->second.id);
+            } else {
+                FLAGS_THROW_EXCEPTION_DEVELOPER(
+                        AddConstraint, "the option named \"--" + optLongName + "\" should be added before the constraint"
+                );
+            }
+        }
+        return mask;
+    }
+
+    FLAGS_INLINE std::string OptionParser::MaskToOptionNames(const std::vector<std::size_t> &ids) const {
+        std::string names;
+        for (auto id: ids) {
+            if (!names.empty()) {
+                names += ", ";
+            }
+            names += _optLongNameToOpt.at(_optIdToOptLongName.at(id)).GetOptionName();
+        }
+        return names;
+    }
+
+    FLAGS_INLINE void OptionParser::FinalizeMasks() {
+        auto count = _optIdToOptLongName.size();
+        _requiredMask.Resize(count);
+        _lazyDefaultMask.Resize(count);
+        _presentMask.Resize(count);
+        for (auto &constraint: _constraints) {
+            constraint.group.Resize(count);
+        }
+    }
+
+    FLAGS_INLINE void OptionParser::CheckConstraints(const ns_priv::OptionMask &present) const {
+        // the masks are combined in place, the id lists are only built for the error messages
+        std::size_t missingId = _optIdToOptLongName.size();
+        _requiredMask.ForEachAndNot(present, [&missingId](std::size_t id) {
+            missingId = std::min(missingId, id);
+        });
+        if (missingId != _optIdToOptLongName.size()) {
+            const auto &opt = _optLongNameToOpt.at(_optIdToOptLongName.at(missingId));
+            if (opt.optionLongName == DEFAULT_OPTION_LONG_NAME) {
+                FLAGS_THROW_EXCEPTION(
+                        SetupFlags, "the default option is 'OptionProp::REQUIRED', but you didn't pass it"
+                );
+            } else {
+                FLAGS_THROW_EXCEPTION(
+                        SetupFlags,
+                        "the option named " + opt.GetOptionName() + " is 'OptionProp::REQUIRED', but you didn't use it"
+                );
+            }
+        }
+
+        for (const auto &constraint: _constraints) {
+            switch (constraint.type) {
+                case ns_priv::ConstraintType::AT_MOST_ONE:
+                    if (present.CountAnd(constraint.group) > 1) {
+                        FLAGS_THROW_EXCEPTION(
+                                SetupFlags,
+                                "the options " + MaskToOptionNames(present.IdsAnd(constraint.group)) +
+                                " are mutually exclusive"
+                        );
+                    }
+                    break;
+                case ns_priv::ConstraintType::EXACTLY_ONE:
+                    if (auto used = present.CountAnd(constraint.group);used != 1) {
+                        FLAGS_THROW_EXCEPTION(
+                                SetupFlags,
+                                "exactly one of the options " +
+                                MaskToOptionNames(constraint.group.Ids()) +
+                                " should be used, but " + std::to_string(used) + " are used"
+                        );
+                    }
+                    break;
+                case ns_priv::ConstraintType::REQUIRES:
+                    if (!present.Test(constraint.optionId)) {
+                        break;
+                    }
+                    if (present.CountAnd(constraint.group) != constraint.group.Count()) {
+                        FLAGS_THROW_EXCEPTION(
+                                SetupFlags,
+                                "the option named " +
+                                _optLongNameToOpt.at(_optIdToOptLongName.at(constraint.optionId)).GetOptionName() +
+                                " requires " + MaskToOptionNames(constraint.group.IdsAndNot(present)) +
+                                ", but you didn't use it(them)"
+                        );
+                    }
+                    break;
+            }
+        }
+    }
+
+    FLAGS_INLINE std::vector<std::string> OptionParser::Complete(const std::vector<std::string> &args) {
+        AddBuiltinOptions();
+
+        // the options of a subcommand are registered only if it's selected, the last argv is being completed,
+        // and the subcommand is found as 'SetupFlags' does
+        bool afterOptionName = false;
+        for (auto argIter = args.cbegin(); !args.empty() && argIter != args.cend() - 1; ++argIter) {
+            if (ns_priv::IsAnOption(*argIter) != ns_priv::OptionNameType::NONE) {
+                afterOptionName = true;
+                continue;
+            }
+            if (auto iter = _subcommands.find(*argIter);!afterOptionName && iter != _subcommands.end()) {
+                return GetSubcommandParser(iter->second).Complete(std::vector<std::string>(argIter + 1, args.cend()));
+            }
+            afterOptionName = false;
+        }
+
+        if (_optLongNameIndex.empty()) {
+            _optLongNameIndex.reserve(_optLongNameToOpt.size());
+            for (const auto &[optLongName, opt]: _optLongNameToOpt) {
+                if (optLongName != DEFAULT_OPTION_LONG_NAME) {
+                    _optLongNameIndex.push_back(optLongName);
+                }
+            }
+            std::sort(_optLongNameIndex.begin(), _optLongNameIndex.end());
+        }
+
+        const std::string cur = args.empty() ? "" : args.back();
+        std::vector<std::string> candidates;
+        auto addLongNames = [this, &candidates](const std::string &prefix) {
+            for (auto iter = std::lower_bound(_optLongNameIndex.cbegin(), _optLongNameIndex.cend(), prefix);
+                 iter != _optLongNameIndex.cend() && iter->compare(0, prefix.size(), prefix) == 0; ++iter) {
+                candidates.push_back("--" + *iter);
+            }
+        };
+
+        if (cur.size() >= 2 && cur.compare(0, 2, "--") == 0) {
+            addLongNames(cur.substr(2));
+        } else if (!cur.empty() && cur.front() == '-') {
+            for (const auto &[optShortName, optLongName]: _optShortNameToOptLongName) {
+                if (optShortName != EMPTY_OPTION_SHORT_NAME && (cur.size() == 1 || cur.at(1) == optShortName)) {
+                    candidates.push_back(std::string("-") + optShortName);
+                }
+            }
+            if (cur.size() == 1) {
+                addLongNames("");
+            }
+        } else {
+            // the subcommands, which may follow the top-level options
+            for (const auto &[name, sub]: _subcommands) {
+                if (name.compare(0, cur.size(), cur) == 0) {
+                    candidates.push_back(name);
+                }
+            }
+            // the values of the last option
+            const ns_priv::Option *lastOpt = nullptr;
+            for (auto iter = args.crbegin() + (args.empty() ? 0 : 1); iter != args.crend(); ++iter) {
+                auto type = ns_priv::IsAnOption(*iter);
+                if (type == ns_priv::OptionNameType::OPT_LONG_NAME) {
+                    if (auto optIter = _optLongNameToOpt.find(iter->substr(2));optIter != _optLongNameToOpt.cend()) {
+                        lastOpt = &optIter->second;
+                    }
+                    break;
+                } else if (type == ns_priv::OptionNameType::OPT_SHORT_NAME) {
+                    if (auto optIter = _optShortNameToOptLongName.find(iter->at(1));
+                            optIter != _optShortNameToOptLongName.cend()) {
+                        lastOpt = &_optLongNameToOpt.at(optIter->second);
+                    }
+                    break;
+                }
+            }
+            if (lastOpt != nullptr) {
+                std::vector<std::string> values;
+                const auto typeName = lastOpt->variable.defaultValue->TypeNameString();
+                if (typeName == "Bool" || typeName == "BoolVec") {
+                    values = {"false", "off", "on", "true"};
+                } else if (typeName.compare(0, 6, "Mapped") == 0) {
+                    values = {"@bin:"};
+                }
+                for (const auto &value: values) {
+                    if (value.compare(0, cur.size(), cur) == 0) {
+                        candidates.push_back(value);
+                    }
+                }
+            }
+            if (cur.empty()) {
+                addLongNames("");
+            }
+        }
+        return candidates;
+    }
+
+    FLAGS_INLINE std::string OptionParser::StaticCompletionWords() const {
+        std::string words;
+        for (const auto &[name, sub]: _subcommands) {
+            words += name + ' ';
+        }
+        for (const auto &[optLongName, opt]: _optLongNameToOpt) {
+            if (optLongName == DEFAULT_OPTION_LONG_NAME) {
+                continue;
+            }
+            words += "--" + optLongName + ' ';
+            if (opt.optionShortName != EMPTY_OPTION_SHORT_NAME) {
+                words += std::string("-") + opt.optionShortName + ' ';
+            }
+        }
+        if (!words.empty()) {
+            words.pop_back();
+        }
+        return words;
+    }
+
+    FLAGS_INLINE std::string OptionParser::GenBashCompletion(const std::string &programName) const {
+        auto command = programName.substr(programName.find_last_of('/') + 1);
+        auto funcName = command;
+        std::replace_if(funcName.begin(), funcName.end(), [](char c) { return !std::isalnum(c); }, '_');
+
+        std::stringstream stream;
+        stream << "# bash completion for '" << command << "', generated by lib-flags\n"
+               << "_" << funcName << "_flags_complete() {\n"
+               << "    local cur=\"${COMP_WORDS[COMP_CWORD]}\"\n"
+               << "    if [[ ${COMP_CWORD} -gt 1 ]]; then\n"
+               << "        local IFS=$'\\n'\n"
+               << "        COMPREPLY=($(\"${COMP_WORDS[0]}\" " << COMPLETE_COMMAND
+               << " \"${COMP_WORDS[@]:1:COMP_CWORD}\" 2>&1))\n"
+               << "    else\n"
+               << "        COMPREPLY=($(compgen -W \"" << StaticCompletionWords() << "\" -- \"${cur}\"))\n"
+               << "    fi\n"
+               << "}\n"
+               << "complete -F _" << funcName << "_flags_complete " << command << '\n';
+        return stream.str();
+    }
+
+    FLAGS_INLINE std::string OptionParser::GenZshCompletion(const std::string &programName) const {
+        auto command = programName.substr(programName.find_last_of('/') + 1);
+        auto funcName = command;
+        std::replace_if(funcName.begin(), funcName.end(), [](char c) { return !std::isalnum(c); }, '_');
+
+        std::stringstream stream;
+        stream << "#compdef " << command << '\n'
+               << "# zsh completion for '" << command << "', generated by lib-flags\n"
+               << "_" << funcName << "_flags_complete() {\n"
+               << "    local -a candidates\n"
+               << "    if (( CURRENT > 2 )); then\n"
+               << "        candidates=(${(f)\"$(${words[1]} " << COMPLETE_COMMAND
+               << " \"${(@)words[2,CURRENT]}\" 2>&1)\"})\n"
+               << "    else\n"
+               << "        candidates=(" << StaticCompletionWords() << ")\n"
+               << "    fi\n"
+               << "    compadd -a candidates\n"
+               << "}\n"
+               << "compdef _" << funcName << "_flags_complete " << command << '\n';
+        return stream.str();
+    }
+
+    FLAGS_INLINE void OptionParser::Reload(const std::vector<std::string> &args) {
+        std::vector<std::pair<const ns_priv::Option *, std::vector<std::string>>> inputOptArgs;
+
+        for (const auto &str: args) {
+            const ns_priv::Option *opt = nullptr;
+            switch (ns_priv::IsAnOption(str)) {
+                case ns_priv::OptionNameType::OPT_SHORT_NAME:
+                    if (auto iter = _optShortNameToOptLongName.find(str.at(1));
+                            iter != _optShortNameToOptLongName.cend()) {
+                        opt = &_optLongNameToOpt.at(iter->second);
+                    }
+                    break;
+                case ns_priv::OptionNameType::OPT_LONG_NAME:
+                    if (auto iter = _optLongNameToOpt.find(str.substr(2));iter != _optLongNameToOpt.cend()) {
+                        opt = &iter->second;
+                    }
+                    break;
+                case ns_priv::OptionNameType::NONE:
+                    if (inputOptArgs.empty()) {
+                        FLAGS_THROW_EXCEPTION(Reload, "the argv \"" + str + "\" doesn't belong to any option");
+                    }
+                    inputOptArgs.back().second.push_back(str);
+                    continue;
+            }
+            if (opt == nullptr) {
+                FLAGS_THROW_EXCEPTION(Reload, "there isn't option named \"" + str + "\"");
+            }
+            if (opt->reloader == nullptr) {
+                FLAGS_THROW_EXCEPTION(Reload, "the option named " + opt->GetOptionName() + " isn't reloadable");
+            }
+            inputOptArgs.emplace_back(opt, std::vector<std::string>());
+        }
+
+        // convert and assert all the values before publishing any of them
+        std::vector<std::pair<const ns_priv::Option *, std::shared_ptr<Argument>>> staged;
+        staged.reserve(inputOptArgs.size());
+        for (const auto &[opt, inputArgs]: inputOptArgs) {
+            auto arg = opt->reloader->create();
+            if (auto msg = arg->DataFromStringVector(inputArgs);msg) {
+                FLAGS_THROW_EXCEPTION(
+                        Reload, "the value(s) for option " + opt->GetOptionName() + " is(are) invalid: \"" + *msg + "\""
+                );
+            }
+            opt->AssertOptionValue(arg);
+            staged.emplace_back(opt, arg);
+        }
+        for (const auto &[opt, arg]: staged) {
+            opt->reloader->publish(arg);
+        }
+    }
+
+    FLAGS_INLINE void OptionParser::ReloadFromFile(const std::string &filename) {
+        std::ifstream file(filename, std::ios::in);
+        if (!file.is_open()) {
+            FLAGS_THROW_EXCEPTION(ReloadFromFile, "can't open the file \"" + filename + "\"");
+        }
+        std::vector<std::string> args;
+        for (std::string str; file >> str;) {
+            args.push_back(str);
+        }
+        Reload(args);
+    }
+
+    FLAGS_INLINE void OptionParser::ThrowHelpDocs(const std::string &programName) {
+        // the help docs are only generated when they are asked for
+        if (this->_autoGenHelpDocs) {
+            auto scope = ns_priv::PhaseScope(_phaseObserver, ParsePhase::HELP);
+            this->AutoGenHelpDocs(programName);
+        }
+        throw std::runtime_error(GetHelpOption().variable.defaultValue->ValueString());
+    }
+
+    FLAGS_INLINE void OptionParser::AutoGenHelpDocs(const std::string &programName) {
+        std::stringstream stream;
+
+        // program description
+        if (!_progDescription.empty()) {
+            stream << _progDescription << "\n\n";
+        }
+
+        // the main usage of this program
+        stream << "Usage: " << programName;
+        if (Utils::MapKeyExist(_optLongNameToOpt, DEFAULT_OPTION_LONG_NAME)) {
+            stream << " [def-opt argv(s)]";
+        }
+        stream << " [opt-name argv(s)] ...";
+        if (!_subcommands.empty()) {
+            stream << " [subcommand [its opt-name argv(s)] ...]";
+        }
+        stream << "\n\n";
+
+        // the header of the help docs
+        stream << "    " << std::setw(15) << std::left << "Options"
+               << std::setw(15) << std::left << "Property"
+               << std::setw(15) << std::left << "Type"
+               << "Describes\n";
+        stream << std::string(62, '-') << '\n';
+
+        if (Utils::MapKeyExist(_optLongNameToOpt, DEFAULT_OPTION_LONG_NAME)) {
+            auto &nopt = _optLongNameToOpt.at(DEFAULT_OPTION_LONG_NAME);
+            stream << "  --" << std::setw(15) << std::left << "def-opt"
+                   << std::setw(15) << std::left << nopt.property
+                   << std::setw(15) << std::left << nopt.variable.defaultValue->TypeNameString()
+                   << nopt.description << "\n\n";
+        }
+
+        for (const auto &elem: _optLongNameToOpt) {
+            if (elem.first == "help" || elem.first == "version" || elem.first == DEFAULT_OPTION_LONG_NAME) {
+                continue;
+            }
+            if (elem.second.optionShortName != EMPTY_OPTION_SHORT_NAME) {
+                stream << "  --" << std::setw(15) << std::left
+                       << elem.second.optionLongName + ", -" + elem.second.optionShortName;
+            } else {
+                stream << "  --" << std::setw(15) << std::left << elem.second.optionLongName;
+            }
+            stream << std::setw(15) << std::left << elem.second.property
+                   << std::setw(15) << std::left << elem.second.variable.defaultValue->TypeNameString()
+                   << elem.second.description << '\n';
+        }
+
+        // subcommands, their options are listed by '<subcommand> --help'
+        if (!_subcommands.empty()) {
+            std::vector<std::pair<std::string, const Subcommand *>> subcommands;
+            subcommands.reserve(_subcommands.size());
+            for (const auto &[name, sub]: _subcommands) {
+                subcommands.emplace_back(name, &sub);
+            }
+            std::sort(subcommands.begin(), subcommands.end());
+            stream << "\n    " << std::setw(30) << std::left << "Subcommands" << "Describes\n";
+            for (const auto &[name, sub]: subcommands) {
+                stream << "    " << std::setw(30) << std::left << name << sub->description << '\n';
+            }
+        }
+
+        // help and version
+        auto &help = _optLongNameToOpt.at("help");
+        auto &version = _optLongNameToOpt.at("version");
+        stream << "\n  --" << std::setw(15) << std::left << help.optionLongName + ", -" + help.optionShortName
+               << std::setw(15) << std::left << help.property
+               << std::setw(15) << std::left << help.variable.defaultValue->TypeNameString()
+               << help.description;
+        stream << "\n  --" << std::setw(15) << std::left << version.optionLongName + ", -" + version.optionShortName
+               << std::setw(15) << std::left << version.property
+               << std::setw(15) << std::left << version.variable.defaultValue->TypeNameString()
+               << version.description;
+
+        // suffix
+        stream << "\n\nhelp docs for program \"" + programName + "\"";
+
+        // assign
+        GetHelpOption().variable.defaultValue->DataFromStringVector({stream.str()});
+    }
+}
+
+#endif
@@ -0,0 +1,171 @@
+/**
+ * @file mapped_arg_type.hpp
+ * @brief the argument types backed by memory-mapped binary files, include this header to use them,
+ * it's kept out of 'flags.hpp' for the system headers
+ */
+
+#ifndef FLAGS_MAPPED_ARG_TYPE_HPP
+#define FLAGS_MAPPED_ARG_TYPE_HPP
+
+#include "flags.hpp"
+#include "ostream"
+#include "sstream"
+#include "cstdint"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#include "fcntl.h"
+#include "unistd.h"
+
+namespace ns_flags {
+    /**
+     * @brief a read-only view over a memory-mapped binary file, the mapping is released
+     * when the last view referring to it is destroyed
+     */
+    template<class ElemType>
+    struct MappedSpan {
+    public:
+        using value_type = ElemType;
+
+    protected:
+        std::shared_ptr<const void> region;
+        const ElemType *ptr;
+        std::size_t count;
+
+    public:
+        MappedSpan() : region(nullptr), ptr(nullptr), count(0) {}
+
+        MappedSpan(std::shared_ptr<const void> region, const ElemType *ptr, std::size_t count)
+                : region(std::move(region)), ptr(ptr), count(count) {}
+
+        [[nodiscard]] const ElemType *data() const { return ptr; }
+
+        [[nodiscard]] std::size_t size() const { return count; }
+
+        [[nodiscard]] bool empty() const { return count == 0; }
+
+        [[nodiscard]] const ElemType *begin() const { return ptr; }
+
+        [[nodiscard]] const ElemType *end() const { return ptr + count; }
+
+        const ElemType &operator[](std::size_t idx) const { return ptr[idx]; }
+
+        friend std::ostream &operator<<(std::ostream &os, const MappedSpan &span) {
+            // never dump the whole mapping, it may be gigabytes
+            os << "{mapped, size: " << span.count << '}';
+            return os;
+        }
+    };
+
+    template<class ElemType>
+    struct Utils::IsContiguousOfTrivial<MappedSpan<ElemType>> : std::true_type {
+    };
+
+    namespace ns_priv {
+        /**
+         * @brief map a raw binary file like '@bin:weights.f64' into memory as a read-only span
+         *
+         * @param str the argv, should start with '@bin:'
+         * @param span the span to receive the mapping
+         * @return the error message if the mapping failed
+         */
+        template<class ElemType>
+        std::optional<std::string> MapBinaryFile(const std::string &str, MappedSpan<ElemType> &span) {
+            static_assert(std::is_trivially_copyable_v<ElemType>, "only trivially copyable types can be mapped");
+            const std::string prefix = "@bin:";
+            if (str.compare(0, prefix.size(), prefix) != 0) {
+                return "the argv should be like '" + prefix + "<filename>', but got '" + str + "'";
+            }
+            const std::string filename = str.substr(prefix.size());
+
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd == -1) {
+                return "can't open the binary file '" + filename + "'";
+            }
+            struct stat st{};
+            if (::fstat(fd, &st) == -1) {
+                ::close(fd);
+                return "can't get the size of the binary file '" + filename + "'";
+            }
+            auto bytes = static_cast<std::size_t>(st.st_size);
+            if (bytes % sizeof(ElemType) != 0) {
+                ::close(fd);
+                return "the size of the binary file '" + filename + "' (" + std::to_string(bytes) +
+                       " bytes) isn't a multiple of the element size (" + std::to_string(sizeof(ElemType)) + " bytes)";
+            }
+            if (bytes == 0) {
+                ::close(fd);
+                span = MappedSpan<ElemType>();
+                return {};
+            }
+            void *addr = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            // the mapping keeps its own reference to the file
+            ::close(fd);
+            if (addr == MAP_FAILED) {
+                return "can't map the binary file '" + filename + "' into memory";
+            }
+            if (reinterpret_cast<std::uintptr_t>(addr) % alignof(ElemType) != 0) {
+                ::munmap(addr, bytes);
+                return "the mapping of the binary file '" + filename + "' isn't aligned for the element type";
+            }
+            std::shared_ptr<const void> region(addr, [bytes](const void *p) {
+                ::munmap(const_cast<void *>(p), bytes);
+            });
+            span = MappedSpan<ElemType>(std::move(region), static_cast<const ElemType *>(addr),
+                                        bytes / sizeof(ElemType));
+            return {};
+        }
+    }
+
+    /**
+     * int binary-file-backed type argument, passed as '@bin:<filename>'
+     */
+    FLAGS_ARGUMENT_TEMPLATE_GENERATOR_BEGIN(MappedIntVec, MappedSpan<int>)
+
+        std::optional<std::string> DataFromStringVector(const std::vector<std::string> &strVec) override {
+            if (strVec.size() != 1) {
+                return "exactly one '@bin:<filename>' argv is needed";
+            }
+            return ns_priv::MapBinaryFile(strVec.front(), data);
+        }
+
+        [[nodiscard]] bool KeepsDataOnEmptyInput() const override {
+            return false;
+        }
+    FLAGS_ARGUMENT_TEMPLATE_GENERATOR_END
+
+    /**
+     * float binary-file-backed type argument, passed as '@bin:<filename>'
+     */
+    FLAGS_ARGUMENT_TEMPLATE_GENERATOR_BEGIN(MappedFloatVec, MappedSpan<float>)
+
+        std::optional<std::string> DataFromStringVector(const std::vector<std::string> &strVec) override {
+            if (strVec.size() != 1) {
+                return "exactly one '@bin:<filename>' argv is needed";
+            }
+            return ns_priv::MapBinaryFile(strVec.front(), data);
+        }
+
+        [[nodiscard]] bool KeepsDataOnEmptyInput() const override {
+            return false;
+        }
+    FLAGS_ARGUMENT_TEMPLATE_GENERATOR_END
+
+    /**
+     * double binary-file-backed type argument, passed as '@bin:<filename>'
+     */
+    FLAGS_ARGUMENT_TEMPLATE_GENERATOR_BEGIN(MappedDoubleVec, MappedSpan<double>)
+
+        std::optional<std::string> DataFromStringVector(const std::vector<std::string> &strVec) override {
+            if (strVec.size() != 1) {
+                return "exactly one '@bin:<filename>' argv is needed";
+            }
+            return ns_priv::MapBinaryFile(strVec.front(), data);
+        }
+
+        [[nodiscard]] bool KeepsDataOnEmptyInput() const override {
+            return false;
+        }
+    FLAGS_ARGUMENT_TEMPLATE_GENERATOR_END
+}
+
+#endif
@@ -0,0 +1,125 @@
+/**
+ * @file reloadable.hpp
+ * @brief the values of the options which can be reloaded at runtime, include this header to use
+ * 'OptionParser::AddReloadableOption', it's kept out of 'flags.hpp' for the threading headers
+ */
+
+#ifndef FLAGS_RELOADABLE_HPP
+#define FLAGS_RELOADABLE_HPP
+
+#include "flags.hpp"
+#include "atomic"
+#include "array"
+#include "mutex"
+#include "thread"
+
+namespace ns_flags {
+    /**
+     * @brief a value which is read through lock-free snapshots and replaced atomically by the writers
+     *
+     * the versions live in a fixed number of slots, a slot is reused by the writer only when it's
+     * neither the current one nor held by any snapshot, so the old versions are reclaimed safely
+     *
+     * @attention the snapshots should be short-lived, otherwise the writer waits for a free slot
+     */
+    template<class DataType, std::size_t SlotCount>
+    class Reloadable {
+        static_assert(SlotCount >= 2, "at least two slots are needed");
+
+    private:
+        struct Slot {
+            DataType value;
+            mutable std::atomic<std::uint32_t> readers{0};
+        };
+
+        std::array<Slot, SlotCount> _slots;
+        std::atomic<std::size_t> _current;
+        std::atomic<std::uint64_t> _version;
+        std::mutex _writerMutex;
+
+    public:
+        using data_type = DataType;
+
+        /**
+         * @brief a consistent view of the value, the version it refers to won't be reclaimed while it's alive
+         */
+        class Snapshot {
+        private:
+            const Slot *_slot;
+
+        public:
+            explicit Snapshot(const Slot *slot) : _slot(slot) {}
+
+            Snapshot(const Snapshot &) = delete;
+
+            Snapshot &operator=(const Snapshot &) = delete;
+
+            Snapshot(Snapshot &&other) noexcept: _slot(other._slot) { other._slot = nullptr; }
+
+            ~Snapshot() {
+                if (_slot != nullptr) { _slot->readers.fetch_sub(1); }
+            }
+
+            const DataType &operator*() const { return _slot->value; }
+
+            const DataType *operator->() const { return &_slot->value; }
+
+            [[nodiscard]] const DataType &Get() const { return _slot->value; }
+        };
+
+    public:
+        explicit Reloadable(const DataType &value = {}) : _current(0), _version(0) {
+            _slots.front().value = value;
+        }
+
+        Reloadable(const Reloadable &) = delete;
+
+        Reloadable &operator=(const Reloadable &) = delete;
+
+        /**
+         * @brief take a snapshot of the current version without locking
+         */
+        [[nodiscard]] Snapshot Read() const {
+            while (true) {
+                auto idx = _current.load();
+                const auto &slot = _slots[idx];
+                slot.readers.fetch_add(1);
+                // the slot may be retired and reused between the load and the increment, so check it again
+                if (_current.load() == idx) {
+                    return Snapshot(&slot);
+                }
+                slot.readers.fetch_sub(1);
+            }
+        }
+
+        /**
+         * @brief get the count of the published versions
+         */
+        [[nodiscard]] std::uint64_t GetVersion() const {
+            return _version.load();
+        }
+
+        /**
+         * @brief publish a new version, the readers see either the old version or the new one
+         */
+        void Publish(const DataType &value) {
+            std::lock_guard<std::mutex> lock(_writerMutex);
+            auto current = _current.load();
+            while (true) {
+                for (std::size_t idx = 0; idx != SlotCount; ++idx) {
+                    if (idx == current || _slots[idx].readers.load() != 0) {
+                        continue;
+                    }
+                    _slots[idx].value = value;
+                    _current.store(idx);
+                    _version.fetch_add(1);
+                    return;
+                }
+                // all the retired versions are still held by the snapshots
+                std::this_thread::yield();
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,309 @@
+/**
+ * @file shared_options.hpp
+ * @brief share the parsed options with other processes through a POSIX shared-memory segment,
+ * include this header to publish or attach the options
+ */
+
+#ifndef FLAGS_SHARED_OPTIONS_HPP
+#define FLAGS_SHARED_OPTIONS_HPP
+
+#include "flags.hpp"
+#include "mapped_arg_type.hpp"
+#include "cstring"
+#include "cerrno"
+#include "string_view"
+#include "atomic"
+#include "new"
+
+namespace ns_flags {
+    namespace ns_priv {
+        /**
+         * @brief the position-independent layout of the segment, all the offsets are relative to its beginning
+         *
+         * [Header][Slot * capacity][names, type names and data, each data block is aligned to 'ALIGNMENT']
+         *
+         * the slots form an open-addressing hash table on the option long names, so both attaching
+         * and looking up cost O(1) no matter how large the schema is
+         */
+        struct SharedLayout {
+        public:
+            // "libflags" in little endian, it's stored last, so a segment is valid once its magic is seen
+            static constexpr std::uint64_t MAGIC = 0x7367616c6662696cULL;
+            static constexpr std::uint32_t VERSION = 1;
+            static constexpr std::size_t ALIGNMENT = 16;
+
+            static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                          "the magic is shared between processes, so its atomic should be lock-free");
+
+            struct Header {
+                std::atomic<std::uint64_t> magic;
+                std::uint32_t version;
+                std::uint32_t capacity;
+                std::uint64_t size;
+            };
+
+            struct Slot {
+                std::uint64_t hash;
+                std::uint64_t nameOffset, nameSize;
+                std::uint64_t typeOffset, typeSize;
+                std::uint64_t dataOffset, dataSize;
+            };
+
+            struct Entry {
+                std::string name, typeName;
+                // the data is written straight into the segment, without any intermediate buffer
+                const Argument *value;
+                std::size_t dataSize;
+            };
+
+        public:
+            static std::uint64_t Hash(std::string_view str) {
+                // FNV-1a
+                std::uint64_t hash = 14695981039346656037ULL;
+                for (char c: str) {
+                    hash ^= static_cast<unsigned char>(c);
+                    hash *= 1099511628211ULL;
+                }
+                return hash;
+            }
+
+            /**
+             * @brief serialize the entries to the zero-filled memory at 'base', the magic is stored last
+             * with the release order, so the readers which see it see the whole segment
+             *
+             * @param base the beginning of the segment, only the size is computed if it's nullptr
+             * @return the size of the segment
+             */
+            static std::size_t Write(const std::vector<Entry> &entries, char *base) {
+                std::uint32_t capacity = 1;
+                while (capacity < 2 * entries.size()) { capacity <<= 1; }
+
+                std::size_t offset = sizeof(Header) + capacity * sizeof(Slot);
+                auto *slots = base == nullptr ? nullptr : reinterpret_cast<Slot *>(base + sizeof(Header));
+                auto reserve = [&offset](std::size_t size, std::size_t alignment) {
+                    offset += (alignment - offset % alignment) % alignment;
+                    auto begin = offset;
+                    offset += size;
+                    return begin;
+                };
+
+                for (const auto &entry: entries) {
+                    auto nameOffset = reserve(entry.name.size(), 1);
+                    auto typeOffset = reserve(entry.typeName.size(), 1);
+                    auto dataOffset = reserve(entry.dataSize, ALIGNMENT);
+                    if (base == nullptr) {
+                        continue;
+                    }
+                    auto hash = Hash(entry.name);
+                    auto idx = hash & (capacity - 1);
+                    while (slots[idx].nameSize != 0) { idx = (idx + 1) & (capacity - 1); }
+                    slots[idx] = Slot{hash, nameOffset, entry.name.size(), typeOffset, entry.typeName.size(),
+                                      dataOffset, entry.dataSize};
+                    std::memcpy(base + nameOffset, entry.name.data(), entry.name.size());
+                    std::memcpy(base + typeOffset, entry.typeName.data(), entry.typeName.size());
+                    entry.value->DataToRawBytes(base + dataOffset);
+                }
+
+                if (base != nullptr) {
+                    auto *header = new(base) Header{{0}, VERSION, capacity, offset};
+                    header->magic.store(MAGIC, std::memory_order_release);
+                }
+                return offset;
+            }
+
+            /**
+             * @brief find the slot of the option in the segment
+             *
+             * @return nullptr if the option isn't in the segment
+             */
+            static const Slot *Find(const char *base, std::string_view name) {
+                const auto &header = *reinterpret_cast<const Header *>(base);
+                const auto *slots = reinterpret_cast<const Slot *>(base + sizeof(Header));
+                auto hash = Hash(name);
+                for (auto idx = hash & (header.capacity - 1);; idx = (idx + 1) & (header.capacity - 1)) {
+                    const auto &slot = slots[idx];
+                    if (slot.nameSize == 0) {
+                        return nullptr;
+                    }
+                    if (slot.hash == hash && std::string_view(base + slot.nameOffset, slot.nameSize) == name) {
+                        return &slot;
+                    }
+                }
+            }
+        };
+
+        template<class DataType>
+        struct SharedView {
+            static_assert(std::is_trivially_copyable_v<DataType>, "this type can't be shared between processes");
+            using type = const DataType &;
+        };
+
+        template<>
+        struct SharedView<std::string> {
+            using type = std::string_view;
+        };
+
+        template<class ElemType>
+        struct SharedView<std::vector<ElemType>> {
+            static_assert(std::is_trivially_copyable_v<ElemType>, "this type can't be shared between processes");
+            using type = MappedSpan<ElemType>;
+        };
+
+        template<class ElemType>
+        struct SharedView<MappedSpan<ElemType>> {
+            using type = MappedSpan<ElemType>;
+        };
+    }
+
+    /**
+     * @brief the read-only view of the options published by 'SharedOptions::Publish',
+     * the values are read in place without any parsing
+     */
+    class SharedOptions {
+    private:
+        std::shared_ptr<const void> _region;
+        const char *_base;
+
+    protected:
+        SharedOptions(std::shared_ptr<const void> region, const char *base)
+                : _region(std::move(region)), _base(base) {}
+
+    public:
+        /**
+         * @brief publish the parsed options to a POSIX shared-memory segment, which can be attached read-only
+         * by other processes through 'SharedOptions::Attach' without parsing, it should be called after 'SetupFlags'
+         *
+         * @param parser the parser whose options are published
+         * @param name the name of the segment, like '/my-flags'
+         *
+         * @attention the options whose values can't be represented by raw bytes are not published. An existing
+         * segment with this name is unlinked rather than rewritten, so the attached readers keep the old values
+         */
+        static void Publish(const OptionParser &parser, const std::string &name) {
+            std::vector<ns_priv::SharedLayout::Entry> entries;
+            entries.reserve(parser.GetOptionMap().size());
+            for (const auto &[optLongName, opt]: parser.GetOptionMap()) {
+                if (optLongName == "help" || optLongName == "version") {
+                    continue;
+                }
+                if (auto size = opt.variable.value->RawBytesSize();size) {
+                    entries.push_back({optLongName, opt.variable.value->TypeNameString(), opt.variable.value.get(),
+                                       *size});
+                }
+            }
+            auto bytes = ns_priv::SharedLayout::Write(entries, nullptr);
+
+            auto error = [&name](const std::string &what) {
+                return std::runtime_error("[ error from 'lib-flags':'Publish' ] can't " + what +
+                                          " the shared memory '" + name + "': " + std::strerror(errno));
+            };
+            // never rewrite a published segment in place, the attached readers keep the old one,
+            // and the new one can't be attached until its magic is stored
+            if (::shm_unlink(name.c_str()) == -1 && errno != ENOENT) {
+                throw error("unlink the old");
+            }
+            int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd == -1) {
+                throw error("create");
+            }
+            if (::ftruncate(fd, static_cast<off_t>(bytes)) == -1) {
+                auto exception = error("resize");
+                ::close(fd);
+                ::shm_unlink(name.c_str());
+                throw exception;
+            }
+            void *addr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (addr == MAP_FAILED) {
+                auto exception = error("map");
+                ::close(fd);
+                ::shm_unlink(name.c_str());
+                throw exception;
+            }
+            ::close(fd);
+            ns_priv::SharedLayout::Write(entries, static_cast<char *>(addr));
+            ::munmap(addr, bytes);
+        }
+
+        /**
+         * @brief attach to the segment read-only
+         *
+         * @param name the name of the POSIX shared-memory segment, like '/my-flags'
+         */
+        static SharedOptions Attach(const std::string &name) {
+            int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+            if (fd == -1) {
+                throw std::runtime_error("[ error from 'lib-flags':'Attach' ] can't open the shared memory '" + name + "'");
+            }
+            struct stat st{};
+            if (::fstat(fd, &st) == -1 || static_cast<std::size_t>(st.st_size) < sizeof(ns_priv::SharedLayout::Header)) {
+                ::close(fd);
+                throw std::runtime_error("[ error from 'lib-flags':'Attach' ] the shared memory '" + name + "' is invalid");
+            }
+            auto bytes = static_cast<std::size_t>(st.st_size);
+            void *addr = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (addr == MAP_FAILED) {
+                throw std::runtime_error("[ error from 'lib-flags':'Attach' ] can't map the shared memory '" + name + "'");
+            }
+            std::shared_ptr<const void> region(addr, [bytes](const void *p) {
+                ::munmap(const_cast<void *>(p), bytes);
+            });
+            const auto *base = static_cast<const char *>(addr);
+            const auto &header = *reinterpret_cast<const ns_priv::SharedLayout::Header *>(base);
+            // pairs with the release store of the publisher, the segment is complete once the magic is seen
+            if (header.magic.load(std::memory_order_acquire) != ns_priv::SharedLayout::MAGIC ||
+                header.version != ns_priv::SharedLayout::VERSION || header.size != bytes) {
+                throw std::runtime_error("[ error from 'lib-flags':'Attach' ] the shared memory '" + name +
+                                         "' isn't published by lib-flags, or it's being published");
+            }
+            return {std::move(region), base};
+        }
+
+        /**
+         * @brief remove the segment, the attached processes can still read it
+         */
+        static void Unlink(const std::string &name) {
+            ::shm_unlink(name.c_str());
+        }
+
+        [[nodiscard]] bool HasOption(const std::string &optLongName) const {
+            return ns_priv::SharedLayout::Find(_base, optLongName) != nullptr;
+        }
+
+        /**
+         * @tparam ArgumentType the type of the option's argument, should be the same as the one passed to 'AddOption',
+         * or its base type, like 'Int' for 'Bound<Int>' or 'Validated<Int, Positive>'
+         *
+         * @return a reference to scalars, a 'std::string_view' to strings and a 'MappedSpan' to vectors
+         *
+         * @attention the references and the string views point into the mapping, they are valid only while this
+         * 'SharedOptions' object lives, while the spans keep the mapping alive by themselves
+         */
+        template<class ArgumentType>
+        typename ns_priv::SharedView<typename ArgumentType::data_type>::type
+        Get(const std::string &optLongName) const {
+            using data_type = typename ArgumentType::data_type;
+            const auto *slot = ns_priv::SharedLayout::Find(_base, optLongName);
+            if (slot == nullptr) {
+                throw std::runtime_error("[ error from 'lib-flags':'Get' ] there isn't shared option named \"--" +
+                                         optLongName + "\"");
+            }
+            if (std::string_view(_base + slot->typeOffset, slot->typeSize) != ArgumentType::TypeName()) {
+                throw std::runtime_error("[ error from 'lib-flags':'Get' ] the type of shared option \"--" +
+                                         optLongName + "\" is '" +
+                                         std::string(_base + slot->typeOffset, slot->typeSize) + "'");
+            }
+            const char *data = _base + slot->dataOffset;
+            if constexpr (std::is_same_v<data_type, std::string>) {
+                return {data, slot->dataSize};
+            } else if constexpr (std::is_trivially_copyable_v<data_type>) {
+                return *reinterpret_cast<const data_type *>(data);
+            } else {
+                using elem_type = typename ns_priv::SharedView<data_type>::type::value_type;
+                return {_region, reinterpret_cast<const elem_type *>(data), slot->dataSize / sizeof(elem_type)};
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,211 @@
+/**
+ * @file validator.hpp
+ * @brief compile-time validators for lib-flags
+ */
+
+#ifndef FLAGS_VALIDATOR_HPP
+#define FLAGS_VALIDATOR_HPP
+
+#include "arg_type.hpp"
+
+namespace ns_flags {
+    /**
+     * compile-time validators, each one provides a static 'Check' function,
+     * which returns the error message if the value is invalid
+     */
+
+    /**
+     * @brief the value should be in range [Lo, Hi]
+     */
+    template<auto Lo, auto Hi>
+    struct Range {
+        static_assert(Lo <= Hi, "the lower bound should not be greater than the upper bound");
+
+        template<class Type>
+        static std::optional<std::string> Check(const Type &val) {
+            if (val < Lo || val > Hi) {
+                return "the value should be in range [" + std::to_string(Lo) + ", " + std::to_string(Hi) + "]";
+            }
+            return {};
+        }
+    };
+
+    /**
+     * @brief the value should be greater than zero
+     */
+    struct Positive {
+        template<class Type>
+        static std::optional<std::string> Check(const Type &val) {
+            if (val > Type{}) {
+                return {};
+            }
+            return "the value should be positive";
+        }
+    };
+
+    /**
+     * @brief the integer should be odd
+     */
+    struct Odd {
+        template<class Type>
+        static std::optional<std::string> Check(const Type &val) {
+            if (val % 2 != 0) {
+                return {};
+            }
+            return "the value should be odd";
+        }
+    };
+
+    /**
+     * @brief the integer should be even
+     */
+    struct Even {
+        template<class Type>
+        static std::optional<std::string> Check(const Type &val) {
+            if (val % 2 == 0) {
+                return {};
+            }
+            return "the value should be even";
+        }
+    };
+
+    /**
+     * @brief the string or container shouldn't be empty
+     */
+    struct NonEmpty {
+        template<class Type>
+        static std::optional<std::string> Check(const Type &val) {
+            if (val.empty()) {
+                return "the value shouldn't be empty";
+            }
+            return {};
+        }
+    };
+
+    /**
+     * @brief the size of the string or container should be in range [Lo, Hi]
+     */
+    template<std::size_t Lo, std::size_t Hi = Lo>
+    struct Size {
+        static_assert(Lo <= Hi, "the lower bound should not be greater than the upper bound");
+
+        template<class Type>
+        static std::optional<std::string> Check(const Type &val) {
+            if (val.size() < Lo || val.size() > Hi) {
+                return "the size should be in range [" + std::to_string(Lo) + ", " + std::to_string(Hi) +
+                       "], but it's " + std::to_string(val.size());
+            }
+            return {};
+        }
+    };
+
+    /**
+     * @brief every element of the container should pass the validator
+     */
+    template<class Validator>
+    struct Each {
+        using elem_validator = Validator;
+
+        template<class Type>
+        static std::optional<std::string> Check(const Type &vec) {
+            for (const auto &elem: vec) {
+                if (auto msg = Validator::Check(elem);msg) {
+                    return msg;
+                }
+            }
+            return {};
+        }
+    };
+
+    /**
+     * @brief the value should pass all the validators, they are checked in order
+     */
+    template<class... Validators>
+    struct All {
+        template<class Type>
+        static std::optional<std::string> Check(const Type &val) {
+            std::optional<std::string> msg;
+            // stop at the first failed validator
+            ((msg = Validators::Check(val), !msg) && ...);
+            return msg;
+        }
+    };
+
+    namespace ns_priv {
+        template<class Validator>
+        struct IsEachValidator : std::false_type {
+        };
+
+        template<class Validator>
+        struct IsEachValidator<Each<Validator>> : std::true_type {
+        };
+
+        /**
+         * @brief the built-in vector argument types, whose conversion is known to be element-wise,
+         * the user-defined types may convert the argv(s) in their own way
+         */
+        template<class ArgumentType>
+        struct IsBuiltinVecArgument : std::false_type {
+        };
+
+        template<>
+        struct IsBuiltinVecArgument<IntVec> : std::true_type {
+        };
+
+        template<>
+        struct IsBuiltinVecArgument<BoolVec> : std::true_type {
+        };
+
+        template<>
+        struct IsBuiltinVecArgument<FloatVec> : std::true_type {
+        };
+
+        template<>
+        struct IsBuiltinVecArgument<DoubleVec> : std::true_type {
+        };
+
+        template<>
+        struct IsBuiltinVecArgument<StringVec> : std::true_type {
+        };
+    }
+
+    /**
+     * @brief an argument type which checks the value with the compile-time validator in the conversion
+     * path, e.g. 'Validated<Int, Range<1, 100>>' or 'Validated<IntVec, Each<Odd>>'
+     *
+     * @attention for 'Each<...>' on the built-in vector types, the elements are checked as they are parsed
+     */
+    template<class ArgumentType, class Validator>
+    struct Validated : ArgumentType {
+    public:
+        using data_type = typename ArgumentType::data_type;
+
+        using ArgumentType::ArgumentType;
+
+        ~Validated() override = default;
+
+        std::optional<std::string> DataFromStringVector(const std::vector<std::string> &strVec) override {
+            if constexpr (ns_priv::IsEachValidator<Validator>::value &&
+                          ns_priv::IsBuiltinVecArgument<ArgumentType>::value) {
+                using elem_type = typename data_type::value_type;
+                this->data.clear();
+                this->data.reserve(strVec.size());
+                for (const auto &str: strVec) {
+                    auto elem = Utils::FromString<elem_type>(str);
+                    if (auto msg = Validator::elem_validator::Check(elem);msg) {
+                        return msg;
+                    }
+                    this->data.push_back(elem);
+                }
+                return {};
+            } else {
+                if (auto msg = ArgumentType::DataFromStringVector(strVec);msg) {
+                    return msg;
+                }
+                return Validator::Check(this->data);
+            }
+        }
+    };
+}
+
+#endif